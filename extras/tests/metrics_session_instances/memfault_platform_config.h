@@ -0,0 +1,12 @@
+#pragma once
+
+//! @file
+//!
+//! Copyright (c) Memfault, Inc.
+//! See License.txt for details
+//!
+//! @brief
+//! SDK configuration for the session instance host test
+
+#define MEMFAULT_METRICS_SESSION_MAX_INSTANCES 16
+#define MEMFAULT_METRICS_SESSION_INSTANCES_ARENA_SIZE 2048
@@ -0,0 +1,358 @@
+//! @file
+//!
+//! Copyright (c) Memfault, Inc.
+//! See License.txt for details
+//!
+//! @brief
+//! Host test for metric session instances. Checks that:
+//!  - an instance serializes to the same bytes as the classic session API given the same values
+//!  - reads on many live instances always match a model of the values written
+//!  - threads driving their own instances interleave on memfault_lock() without losing events
+//!  - the instance setters and reads never take memfault_lock() while already holding it
+//!
+//! Lives outside of src/ so the Arduino build never compiles it. Run it with:
+//!   make -C extras/tests/metrics_session_instances
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memfault-firmware-sdk/components/include/memfault/core/data_packetizer_source.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/event_storage.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/log.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/platform/debug_log.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/platform/device_info.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/platform/overrides.h"
+#include "memfault-firmware-sdk/components/include/memfault/metrics/metrics.h"
+#include "memfault-firmware-sdk/components/include/memfault/metrics/platform/timer.h"
+
+#define TEST_KEY(key_name) MEMFAULT_METRICS_KEY(key_name)
+#define TEST_SESSION(key_name) MEMFAULT_METRICS_SESSION_KEY(key_name)
+
+//
+// Platform stubs
+//
+
+static _Atomic uint64_t s_time_ms;
+static pthread_mutex_t s_mutex;
+
+// Set around the instance setter & read calls. Taking the lock while already holding it from
+// one of those is counted, since they are expected to run in a single critical section.
+static __thread bool s_check_nesting;
+static __thread int s_lock_depth;
+static _Atomic long s_nested_locks;
+
+void memfault_lock(void) {
+  pthread_mutex_lock(&s_mutex);
+  s_lock_depth++;
+  if (s_check_nesting && s_lock_depth > 1) {
+    s_nested_locks++;
+  }
+}
+
+void memfault_unlock(void) {
+  s_lock_depth--;
+  pthread_mutex_unlock(&s_mutex);
+}
+
+void memfault_platform_get_device_info(sMemfaultDeviceInfo *info) {
+  *info = (sMemfaultDeviceInfo){
+    .device_serial = "TEST",
+    .software_type = "main",
+    .software_version = "1.0.0",
+    .hardware_version = "host",
+  };
+}
+
+uint64_t memfault_platform_get_time_since_boot_ms(void) {
+  return atomic_load(&s_time_ms);
+}
+
+bool memfault_platform_metrics_timer_boot(uint32_t period_sec,
+                                          MemfaultPlatformTimerCallback callback) {
+  (void)period_sec, (void)callback;
+  return true;
+}
+
+void memfault_metrics_reliability_collect(void) { }
+
+void memfault_platform_log(eMemfaultPlatformLogLevel level, const char *fmt, ...) {
+  (void)level, (void)fmt;
+}
+
+void memfault_log_save(eMemfaultPlatformLogLevel level, const char *fmt, ...) {
+  (void)level, (void)fmt;
+}
+
+void memfault_sdk_assert_func(void) {
+  abort();
+}
+
+//
+// Helpers
+//
+
+static uint8_t s_event_storage[1 << 20];
+static _Atomic long s_events_drained;
+
+static size_t prv_drain_events(uint8_t *out, size_t out_len) {
+  static uint8_t s_event[4096];
+  size_t total = 0;
+  size_t event_size;
+
+  memfault_lock();
+  while (g_memfault_event_data_source.has_more_msgs_cb(&event_size)) {
+    assert(event_size <= sizeof(s_event));
+    g_memfault_event_data_source.read_msg_cb(0, s_event, event_size);
+    if ((out != NULL) && (total + event_size <= out_len)) {
+      memcpy(&out[total], s_event, event_size);
+    }
+    total += event_size;
+    s_events_drained++;
+    g_memfault_event_data_source.mark_msg_read_cb();
+  }
+  memfault_unlock();
+
+  return total;
+}
+
+#define CHECK_NO_NESTING(call) \
+  do {                         \
+    s_check_nesting = true;    \
+    int rv_ = (call);          \
+    s_check_nesting = false;   \
+    assert(rv_ == 0);          \
+  } while (0)
+
+//
+// Tests
+//
+
+static void test_matches_classic_session(void) {
+  static uint8_t s_classic[4096], s_instance[4096];
+  prv_drain_events(NULL, 0);
+
+  atomic_store(&s_time_ms, 1000);
+  assert(MEMFAULT_METRICS_SESSION_START(ble) == 0);
+  MEMFAULT_METRIC_ADD(ble_rx, 5);
+  MEMFAULT_METRIC_SET_SIGNED(ble_rssi, -70);
+  MEMFAULT_METRIC_TIMER_START(ble_busy);
+  MEMFAULT_METRIC_RECORD(ble_lat, 300);
+  MEMFAULT_METRIC_RECORD(ble_lat, 17);
+  MEMFAULT_METRIC_SET_STRING(ble_peer, "aa:bb:cc:dd:ee:ff");
+  atomic_store(&s_time_ms, 1250);
+  MEMFAULT_METRIC_TIMER_STOP(ble_busy);
+  atomic_store(&s_time_ms, 1400);
+  assert(MEMFAULT_METRICS_SESSION_END(ble) == 0);
+  const size_t classic_len = prv_drain_events(s_classic, sizeof(s_classic));
+
+  MemfaultMetricsSessionHandle handle;
+  atomic_store(&s_time_ms, 1000);
+  assert(MEMFAULT_METRICS_SESSION_INSTANCE_START(ble, &handle) == 0);
+  CHECK_NO_NESTING(MEMFAULT_METRIC_INSTANCE_ADD(handle, ble_rx, 5));
+  CHECK_NO_NESTING(MEMFAULT_METRIC_INSTANCE_SET_SIGNED(handle, ble_rssi, -70));
+  CHECK_NO_NESTING(MEMFAULT_METRIC_INSTANCE_TIMER_START(handle, ble_busy));
+  CHECK_NO_NESTING(MEMFAULT_METRIC_INSTANCE_RECORD(handle, ble_lat, 300));
+  CHECK_NO_NESTING(MEMFAULT_METRIC_INSTANCE_RECORD(handle, ble_lat, 17));
+  CHECK_NO_NESTING(MEMFAULT_METRIC_INSTANCE_SET_STRING(handle, ble_peer, "aa:bb:cc:dd:ee:ff"));
+  atomic_store(&s_time_ms, 1250);
+  CHECK_NO_NESTING(MEMFAULT_METRIC_INSTANCE_TIMER_STOP(handle, ble_busy));
+  atomic_store(&s_time_ms, 1400);
+  assert(memfault_metrics_session_instance_end(handle) == 0);
+  const size_t instance_len = prv_drain_events(s_instance, sizeof(s_instance));
+
+  assert(classic_len > 0 && classic_len == instance_len);
+  assert(memcmp(s_classic, s_instance, classic_len) == 0);
+
+  // stale handles, keys from another session and the heartbeat are all refused
+  assert(MEMFAULT_METRIC_INSTANCE_ADD(handle, ble_rx, 1) != 0);
+  assert(memfault_metrics_session_instance_end(handle) != 0);
+  assert(memfault_metrics_session_instance_start(TEST_SESSION(heartbeat), &handle) != 0);
+  assert(MEMFAULT_METRICS_SESSION_INSTANCE_START(dl, &handle) == 0);
+  assert(MEMFAULT_METRIC_INSTANCE_ADD(handle, ble_rx, 1) != 0);
+  assert(MEMFAULT_METRIC_INSTANCE_ADD(handle, counter, 1) != 0);
+  CHECK_NO_NESTING(
+    memfault_metrics_session_instance_set_unsigned64(handle, TEST_KEY(dl_bytes), 1ull << 40));
+  assert(memfault_metrics_session_instance_end(handle) == 0);
+  prv_drain_events(NULL, 0);
+
+  printf("classic session and instance events match (%zu bytes)\n", classic_len);
+}
+
+typedef struct {
+  bool live;
+  bool is_ble;
+  MemfaultMetricsSessionHandle handle;
+  uint32_t rx;
+  int32_t rssi;
+  uint32_t lat_count;
+} sInstanceModel;
+
+static void test_reads_match_model(void) {
+  enum { kNumModels = 64, kIterations = 500000 };
+  static sInstanceModel s_models[kNumModels];
+  long ops = 0, refused = 0;
+  uint32_t heartbeat_count = 0;
+
+  srand(3);
+  memfault_metrics_heartbeat_set_unsigned(TEST_KEY(counter), 0);
+
+  for (int i = 0; i < kIterations; i++) {
+    sInstanceModel *model = &s_models[rand() % kNumModels];
+    if (!model->live) {
+      const eMfltMetricsSessionIndex key = (rand() & 1) ? TEST_SESSION(ble) : TEST_SESSION(dl);
+      if (memfault_metrics_session_instance_start(key, &model->handle) != 0) {
+        // the instance pool or arena is full
+        refused++;
+        continue;
+      }
+      *model = (sInstanceModel){
+        .live = true,
+        .is_ble = key == TEST_SESSION(ble),
+        .handle = model->handle,
+      };
+      continue;
+    }
+
+    if ((rand() % 8) == 0) {
+      assert(memfault_metrics_session_instance_end(model->handle) == 0);
+      model->live = false;
+      continue;
+    }
+
+    const MemfaultMetricsSessionHandle h = model->handle;
+    if (model->is_ble) {
+      const uint32_t amount = (uint32_t)rand() % 1000;
+      const int32_t rssi = -(rand() % 100);
+      model->rx += amount;
+      model->rssi = rssi;
+      model->lat_count++;
+      CHECK_NO_NESTING(
+        memfault_metrics_session_instance_add(h, TEST_KEY(ble_rx), (int32_t)amount));
+      CHECK_NO_NESTING(memfault_metrics_session_instance_set_signed(h, TEST_KEY(ble_rssi), rssi));
+      CHECK_NO_NESTING(memfault_metrics_session_instance_record(h, TEST_KEY(ble_lat), amount));
+
+      uint32_t rx;
+      int32_t rssi_read;
+      sMemfaultMetricHistogram lat;
+      CHECK_NO_NESTING(memfault_metrics_session_instance_read_unsigned(h, TEST_KEY(ble_rx), &rx));
+      CHECK_NO_NESTING(
+        memfault_metrics_session_instance_read_signed(h, TEST_KEY(ble_rssi), &rssi_read));
+      CHECK_NO_NESTING(
+        memfault_metrics_session_instance_read_histogram(h, TEST_KEY(ble_lat), &lat));
+      assert(rx == model->rx && rssi_read == model->rssi && lat.count == model->lat_count);
+    } else {
+      CHECK_NO_NESTING(
+        memfault_metrics_session_instance_sample(h, TEST_KEY(dl_speed), rand() % 500));
+      CHECK_NO_NESTING(memfault_metrics_session_instance_add(h, TEST_KEY(dl_bytes), 1000));
+    }
+
+    // instances never touch the heartbeat values
+    heartbeat_count++;
+    MEMFAULT_METRIC_ADD(counter, 1);
+    uint32_t count;
+    assert(memfault_metrics_heartbeat_read_unsigned(TEST_KEY(counter), &count) == 0);
+    assert(count == heartbeat_count);
+
+    if ((++ops & 0xfff) == 0) {
+      prv_drain_events(NULL, 0);
+    }
+  }
+
+  for (int i = 0; i < kNumModels; i++) {
+    if (s_models[i].live) {
+      assert(memfault_metrics_session_instance_end(s_models[i].handle) == 0);
+    }
+  }
+  prv_drain_events(NULL, 0);
+
+  printf("%ld instance ops matched the model, %ld starts refused\n", ops, refused);
+}
+
+enum { kNumThreads = 8, kThreadIterations = 20000 };
+static _Atomic long s_instances_ended;
+
+static void *prv_instance_thread(void *arg) {
+  unsigned int seed = (unsigned int)(uintptr_t)arg;
+
+  for (int i = 0; i < kThreadIterations; i++) {
+    MemfaultMetricsSessionHandle handle;
+    if (MEMFAULT_METRICS_SESSION_INSTANCE_START(ble, &handle) != 0) {
+      continue;
+    }
+
+    uint32_t expected_rx = 0;
+    const int num_adds = 1 + (rand_r(&seed) % 16);
+    for (int j = 0; j < num_adds; j++) {
+      const uint32_t amount = (uint32_t)rand_r(&seed) % 100;
+      expected_rx += amount;
+      CHECK_NO_NESTING(MEMFAULT_METRIC_INSTANCE_ADD(handle, ble_rx, (int32_t)amount));
+      CHECK_NO_NESTING(MEMFAULT_METRIC_INSTANCE_RECORD(handle, ble_lat, amount));
+      // interleave heartbeat updates from the same threads
+      if ((j & 1) != 0) {
+        MEMFAULT_METRIC_ADD(counter, 1);
+      }
+      if ((j & 3) == 0) {
+        atomic_fetch_add(&s_time_ms, 1);
+      }
+    }
+
+    uint32_t rx;
+    CHECK_NO_NESTING(
+      memfault_metrics_session_instance_read_unsigned(handle, TEST_KEY(ble_rx), &rx));
+    assert(rx == expected_rx);
+
+    // ending an instance must never drop the event, even with other threads serializing
+    assert(memfault_metrics_session_instance_end(handle) == 0);
+    s_instances_ended++;
+
+    if ((i & 63) == 0) {
+      prv_drain_events(NULL, 0);
+    }
+  }
+
+  return NULL;
+}
+
+static void test_threads_interleave(void) {
+  pthread_t threads[kNumThreads];
+
+  prv_drain_events(NULL, 0);
+  s_events_drained = 0;
+
+  for (int i = 0; i < kNumThreads; i++) {
+    pthread_create(&threads[i], NULL, prv_instance_thread, (void *)(uintptr_t)(i + 1));
+  }
+  for (int i = 0; i < kNumThreads; i++) {
+    pthread_join(threads[i], NULL);
+  }
+  prv_drain_events(NULL, 0);
+
+  assert(s_events_drained == s_instances_ended);
+  printf("%d threads ended %ld instances, every event serialized\n", kNumThreads,
+         (long)s_instances_ended);
+}
+
+int main(void) {
+  pthread_mutexattr_t attr;
+  pthread_mutexattr_init(&attr);
+  // memfault_lock() is documented to be recursive
+  pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+  pthread_mutex_init(&s_mutex, &attr);
+
+  const sMemfaultEventStorageImpl *storage =
+    memfault_events_storage_boot(s_event_storage, sizeof(s_event_storage));
+  sMemfaultMetricBootInfo boot_info = { .unexpected_reboot_count = 0 };
+  assert(memfault_metrics_boot(storage, &boot_info) == 0);
+
+  test_matches_classic_session();
+  test_reads_match_model();
+  test_threads_interleave();
+
+  assert(s_nested_locks == 0);
+  printf("PASS\n");
+  return 0;
+}
@@ -6,6 +6,7 @@
 #include <inttypes.h>
 #include <string.h>
 
+#include "memfault-firmware-sdk/components/include/memfault/config.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/compiler.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/data_packetizer.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/data_packetizer_source.h"
@@ -99,7 +100,8 @@ typedef struct MemfaultDataSource {
 static const sMemfaultDataSource s_memfault_data_source[] = {
   {
     .type = kMfltMessageType_Coredump,
-    .use_rle = true,
+    // memory regions are already run length encoded when the coredump is saved
+    .use_rle = !MEMFAULT_COREDUMP_COMPRESS_REGIONS,
     .impl = &g_memfault_coredump_data_source,
   },
   {
@@ -84,6 +84,30 @@ bool memfault_data_source_rle_encoder_set_active(const sMemfaultDataSourceImpl *
   return true;
 }
 
+//! Get the next bytes of the backing message to encode
+//!
+//! The bytes are used in place when the backing data source is memory mapped and are copied into
+//! temp_buf otherwise
+//!
+//! @param offset The offset within the backing message to start at
+//! @param max_len The most bytes to return
+//! @param len_out Populated with the number of bytes returned
+static const uint8_t *prv_get_backing_data(uint32_t offset, size_t max_len, size_t *len_out) {
+  const sMemfaultDataSourceImpl *source = s_active_data_source;
+  const void *read_ptr = NULL;
+  size_t read_ptr_len = 0;
+  if ((source->get_read_pointer_cb != NULL) &&
+      source->get_read_pointer_cb(offset, &read_ptr, &read_ptr_len) && (read_ptr_len != 0)) {
+    *len_out = MEMFAULT_MIN(read_ptr_len, max_len);
+    return read_ptr;
+  }
+
+  uint8_t *working_buf = &s_ds_rle_state.encode_ctx.temp_buf[0];
+  *len_out = MEMFAULT_MIN(max_len, sizeof(s_ds_rle_state.encode_ctx.temp_buf));
+  source->read_msg_cb(offset, working_buf, *len_out);
+  return working_buf;
+}
+
 static bool prv_data_source_rle_has_more_msgs_prepare(const void *data, size_t data_len) {
   const uint8_t *buf = data;
 
@@ -199,15 +223,11 @@ static bool prv_data_source_rle_read(uint32_t offset, void *buf, size_t buf_len)
   }
 
   while (encode_ctx->bytes_processed != s_ds_rle_state.original_size) {
-    uint8_t *working_buf = &encode_ctx->temp_buf[0];
-    const size_t working_buf_size = sizeof(encode_ctx->temp_buf);
-
     const size_t bytes_remaining = s_ds_rle_state.original_size - encode_ctx->bytes_processed;
-    const size_t bytes_read = MEMFAULT_MIN(bytes_remaining, working_buf_size);
-
     const size_t read_offset = prv_data_source_rle_get_backing_read_offset();
-    s_active_data_source->read_msg_cb(read_offset, working_buf, bytes_read);
-    prv_data_source_rle_read_msg_prepare(working_buf, bytes_read);
+    size_t bytes_read = 0;
+    const uint8_t *data = prv_get_backing_data(read_offset, bytes_remaining, &bytes_read);
+    prv_data_source_rle_read_msg_prepare(data, bytes_read);
 
     // do we know what to write for the next block yet?
     buf_full = prv_data_source_rle_fill_msg(&bufp, &buf_len);
@@ -229,13 +249,10 @@ static size_t prv_compute_rle_size(void) {
   size_t bytes_processed = 0;
 
   while (bytes_processed != s_ds_rle_state.original_size) {
-    sMemfaultDataSourceRleEncodeCtx *encode_ctx = &s_ds_rle_state.encode_ctx;
-    uint8_t *working_buf = &encode_ctx->temp_buf[0];
-    const size_t working_buf_size = sizeof(encode_ctx->temp_buf);
     const size_t bytes_left = s_ds_rle_state.original_size - bytes_processed;
-    const size_t bytes_to_read = MEMFAULT_MIN(bytes_left, working_buf_size);
-    s_active_data_source->read_msg_cb(bytes_processed, working_buf, bytes_to_read);
-    prv_data_source_rle_has_more_msgs_prepare(working_buf, bytes_to_read);
+    size_t bytes_to_read = 0;
+    const uint8_t *data = prv_get_backing_data(bytes_processed, bytes_left, &bytes_to_read);
+    prv_data_source_rle_has_more_msgs_prepare(data, bytes_to_read);
     bytes_processed += bytes_to_read;
   }
 
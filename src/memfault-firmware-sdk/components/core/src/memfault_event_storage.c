@@ -25,6 +25,7 @@
 #include "memfault-firmware-sdk/components/include/memfault/core/platform/system_time.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/sdk_assert.h"
 #include "memfault-firmware-sdk/components/include/memfault/util/circular_buffer.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/varint.h"
 
 //
 // Routines which can optionally be implemented.
@@ -54,24 +55,29 @@ MEMFAULT_WEAK const sMemfaultNonVolatileEventStorageImpl
     .enabled = prv_nonvolatile_event_storage_enabled,
   };
 
+//! Each event is stored as a varint encoded header holding the size of the event payload followed
+//! by the payload itself. The header for an event being written is sized to describe an event
+//! filling all of the remaining storage and is shrunk to the minimal encoding once the write
+//! completes so small events only carry 1 byte of overhead.
+//!
+//! The event currently being written is tracked in sMemfaultEventStorageWriteState rather than by
+//! a marker in the header. Readers never look beyond the committed events.
 typedef struct {
   bool write_in_progress;
+  //! The number of bytes reserved for the header of the event being written
+  size_t hdr_reserved_bytes;
+  //! The total bytes written for the event being written, including the reserved header
   size_t bytes_written;
 } sMemfaultEventStorageWriteState;
 
 typedef struct {
   size_t active_event_read_size;
   size_t num_events;
+  //! The number of bytes in active_event_read_size used by event headers
+  size_t hdr_overhead_bytes;
   sMemfaultBatchedEventsHeader event_header;
 } sMemfaultEventStorageReadState;
 
-#define MEMFAULT_EVENT_STORAGE_WRITE_IN_PROGRESS 0xffff
-
-typedef MEMFAULT_PACKED_STRUCT {
-  uint16_t total_size;
-}
-sMemfaultEventStorageHeader;
-
 static sMfltCircularBuffer s_event_storage;
 static sMemfaultEventStorageWriteState s_event_storage_write_state;
 static sMemfaultEventStorageReadState s_event_storage_read_state;
@@ -97,8 +103,39 @@ static size_t prv_get_total_event_size(sMemfaultEventStorageReadState *state) {
     return 0;
   }
 
-  const size_t hdr_overhead_bytes = state->num_events * sizeof(sMemfaultEventStorageHeader);
-  return (state->active_event_read_size + state->event_header.length) - hdr_overhead_bytes;
+  return (state->active_event_read_size + state->event_header.length) - state->hdr_overhead_bytes;
+}
+
+//! @return the number of bytes in storage which belong to fully written events
+//!
+//! @note Must be called with memfault_lock() held
+static size_t prv_get_committed_size(void) {
+  const size_t bytes_used = memfault_circular_buffer_get_read_size(&s_event_storage);
+  if (!s_event_storage_write_state.write_in_progress) {
+    return bytes_used;
+  }
+  return bytes_used - s_event_storage_write_state.bytes_written;
+}
+
+//! Decode the header of the event stored at the provided offset
+//!
+//! @param offset The offset within storage where the event begins
+//! @param[out] payload_size Populated with the size of the event payload
+//!
+//! @return the size of the header or 0 if no valid header could be read
+static size_t prv_read_event_header(size_t offset, uint32_t *payload_size) {
+  const size_t bytes_used = memfault_circular_buffer_get_read_size(&s_event_storage);
+  if (offset >= bytes_used) {
+    return 0;
+  }
+
+  uint8_t hdr[MEMFAULT_UINT32_MAX_VARINT_LENGTH];
+  const size_t hdr_read_len = MEMFAULT_MIN(sizeof(hdr), bytes_used - offset);
+  if (!memfault_circular_buffer_read(&s_event_storage, offset, hdr, hdr_read_len)) {
+    return 0;
+  }
+
+  return memfault_decode_varint_u32(hdr, hdr_read_len, payload_size);
 }
 
 //! Walk the ram-backed event storage and determine data to read
@@ -106,16 +143,18 @@ static size_t prv_get_total_event_size(sMemfaultEventStorageReadState *state) {
 //! @return true if computation was successful, false otherwise
 static void prv_compute_read_state(sMemfaultEventStorageReadState *state) {
   *state = (sMemfaultEventStorageReadState){ 0 };
-  while (1) {
-    sMemfaultEventStorageHeader hdr = { 0 };
-    const bool success = memfault_circular_buffer_read(
-      &s_event_storage, state->active_event_read_size, &hdr, sizeof(hdr));
-    if (!success || hdr.total_size == MEMFAULT_EVENT_STORAGE_WRITE_IN_PROGRESS) {
+  const size_t committed_size = prv_get_committed_size();
+  while (state->active_event_read_size < committed_size) {
+    uint32_t payload_size = 0;
+    const size_t hdr_size = prv_read_event_header(state->active_event_read_size, &payload_size);
+    if (hdr_size == 0) {
       break;
     }
 
+    const size_t total_size = hdr_size + payload_size;
     state->num_events++;
-    state->active_event_read_size += hdr.total_size;
+    state->active_event_read_size += total_size;
+    state->hdr_overhead_bytes += hdr_size;
 
 #if (MEMFAULT_EVENT_STORAGE_READ_BATCHING_ENABLED == 0)
     // if batching is disabled, only one event will be read at a time
@@ -125,7 +164,8 @@ static void prv_compute_read_state(sMemfaultEventStorageReadState *state) {
         (prv_get_total_event_size(state) > MEMFAULT_EVENT_STORAGE_READ_BATCHING_MAX_BYTES)) {
       // more bytes than desired, so don't count this event
       state->num_events--;
-      state->active_event_read_size -= hdr.total_size;
+      state->active_event_read_size -= total_size;
+      state->hdr_overhead_bytes -= hdr_size;
       break;
     }
 #endif /* MEMFAULT_EVENT_STORAGE_READ_BATCHING_ENABLED */
@@ -186,16 +226,15 @@ static bool prv_event_storage_read_ram(uint32_t offset, void *buf, size_t buf_le
   uint32_t read_offset = 0;
 
   while (buf_len > 0) {
-    sMemfaultEventStorageHeader hdr = { 0 };
-    const bool success =
-      memfault_circular_buffer_read(&s_event_storage, read_offset, &hdr, sizeof(hdr));
-    if (!success) {
+    uint32_t payload_size = 0;
+    const size_t hdr_size = prv_read_event_header(read_offset, &payload_size);
+    if (hdr_size == 0) {
       // not possible to get here unless there is corruption
       return false;
     }
 
-    read_offset += sizeof(hdr);
-    const size_t event_size = hdr.total_size - sizeof(hdr);
+    read_offset += hdr_size;
+    const size_t event_size = payload_size;
 
     if ((curr_offset + event_size) < offset) {
       // we haven't reached the offset we were trying to read from
@@ -241,41 +280,83 @@ static void prv_event_storage_mark_event_read_ram(void) {
 
 // "begin" to write event data & return the space available
 static size_t prv_event_storage_storage_begin_write(void) {
-  if (s_event_storage_write_state.write_in_progress) {
-    return 0;
-  }
-
-  const sMemfaultEventStorageHeader hdr = {
-    .total_size = MEMFAULT_EVENT_STORAGE_WRITE_IN_PROGRESS,
-  };
-  bool success;
+  size_t space_available = 0;
   memfault_lock();
-  { success = memfault_circular_buffer_write(&s_event_storage, &hdr, sizeof(hdr)); }
-  memfault_unlock();
-  if (!success) {
-    return 0;
+  // Only one event can be written at a time. Checked with the lock held since events can be
+  // encoded without holding it (see MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT).
+  if (!s_event_storage_write_state.write_in_progress) {
+    // Reserve enough space for a header describing an event which fills all of the space that is
+    // left. It gets shrunk to the actual size needed when the write is finished.
+    uint8_t hdr[MEMFAULT_UINT32_MAX_VARINT_LENGTH] = { 0 };
+    const uint32_t bytes_free = (uint32_t)memfault_circular_buffer_get_write_size(&s_event_storage);
+    const size_t hdr_size = memfault_encode_varint_u32(bytes_free, hdr);
+    memset(hdr, 0x0, sizeof(hdr));
+
+    if (memfault_circular_buffer_write(&s_event_storage, hdr, hdr_size)) {
+      space_available = memfault_circular_buffer_get_write_size(&s_event_storage);
+      if (space_available == 0) {
+        // No room left for a payload. Returning 0 means no write was started, so undo the header
+        memfault_circular_buffer_consume_from_end(&s_event_storage, hdr_size);
+      }
+    }
+    if (space_available != 0) {
+      s_event_storage_write_state = (sMemfaultEventStorageWriteState){
+        .write_in_progress = true,
+        .hdr_reserved_bytes = hdr_size,
+        .bytes_written = hdr_size,
+      };
+    }
   }
+  memfault_unlock();
 
-  s_event_storage_write_state = (sMemfaultEventStorageWriteState){
-    .write_in_progress = true,
-    .bytes_written = sizeof(hdr),
-  };
-
-  return memfault_circular_buffer_get_write_size(&s_event_storage);
+  return space_available;
 }
 
 static bool prv_event_storage_storage_append_data(const void *bytes, size_t num_bytes) {
   bool success;
 
   memfault_lock();
-  { success = memfault_circular_buffer_write(&s_event_storage, bytes, num_bytes); }
-  memfault_unlock();
-  if (success) {
-    s_event_storage_write_state.bytes_written += num_bytes;
+  {
+    success = memfault_circular_buffer_write(&s_event_storage, bytes, num_bytes);
+    if (success) {
+      s_event_storage_write_state.bytes_written += num_bytes;
+    }
   }
+  memfault_unlock();
   return success;
 }
 
+//! Encode the final header for the event being written, moving the payload down if the header
+//! needs fewer bytes than were reserved for it in prv_event_storage_storage_begin_write()
+//!
+//! @note Must be called with memfault_lock() held
+static void prv_commit_event_header(void) {
+  const size_t payload_size =
+    s_event_storage_write_state.bytes_written - s_event_storage_write_state.hdr_reserved_bytes;
+
+  uint8_t hdr[MEMFAULT_UINT32_MAX_VARINT_LENGTH];
+  const size_t hdr_size = memfault_encode_varint_u32((uint32_t)payload_size, hdr);
+  const size_t shift = s_event_storage_write_state.hdr_reserved_bytes - hdr_size;
+
+  if (shift != 0) {
+    // Regions overlap but the destination always precedes the source so copying front to back is
+    // safe
+    const size_t payload_start = memfault_circular_buffer_get_read_size(&s_event_storage) -
+                                 payload_size;
+    uint8_t chunk[16];
+    for (size_t i = 0; i < payload_size; i += sizeof(chunk)) {
+      const size_t chunk_size = MEMFAULT_MIN(sizeof(chunk), payload_size - i);
+      memfault_circular_buffer_read(&s_event_storage, payload_start + i, chunk, chunk_size);
+      memfault_circular_buffer_write_at_offset(&s_event_storage, payload_size - i + shift, chunk,
+                                               chunk_size);
+    }
+    memfault_circular_buffer_consume_from_end(&s_event_storage, shift);
+  }
+
+  memfault_circular_buffer_write_at_offset(&s_event_storage, payload_size + hdr_size, hdr,
+                                           hdr_size);
+}
+
 static void prv_event_storage_storage_finish_write(bool rollback) {
   if (!s_event_storage_write_state.write_in_progress) {
     return;
@@ -287,17 +368,13 @@ static void prv_event_storage_storage_finish_write(bool rollback) {
       memfault_circular_buffer_consume_from_end(&s_event_storage,
                                                 s_event_storage_write_state.bytes_written);
     } else {
-      const sMemfaultEventStorageHeader hdr = {
-        .total_size = (uint16_t)s_event_storage_write_state.bytes_written,
-      };
-      memfault_circular_buffer_write_at_offset(
-        &s_event_storage, s_event_storage_write_state.bytes_written, &hdr, sizeof(hdr));
+      prv_commit_event_header();
     }
+
+    // reset the write state
+    s_event_storage_write_state = (sMemfaultEventStorageWriteState){ 0 };
   }
   memfault_unlock();
-
-  // reset the write state
-  s_event_storage_write_state = (sMemfaultEventStorageWriteState){ 0 };
   if (!rollback) {
     prv_invoke_request_persist_callback();
   }
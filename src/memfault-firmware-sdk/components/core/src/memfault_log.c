@@ -18,13 +18,16 @@
 #include "memfault-firmware-sdk/components/include/memfault/core/debug_log.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/log.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/log_impl.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/log_module.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/math.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/platform/core.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/platform/debug_log.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/platform/overrides.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/sdk_assert.h"
 #include "memfault-firmware-sdk/components/include/memfault/util/base64.h"
 #include "memfault-firmware-sdk/components/include/memfault/util/circular_buffer.h"
 #include "memfault-firmware-sdk/components/include/memfault/util/crc16_ccitt.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/crc32.h"
 #include "memfault_log_private.h"
 
 #if MEMFAULT_LOG_DATA_SOURCE_ENABLED
@@ -61,6 +64,49 @@ static sMfltRamLogger s_memfault_ram_logger = {
   .enabled = false,
 };
 
+#define MEMFAULT_LOG_SPILL_ENABLED \
+  (MEMFAULT_LOG_DATA_SOURCE_ENABLED && (MEMFAULT_LOG_SPILL_BUFFER_SIZE > 0))
+
+#if MEMFAULT_LOG_SPILL_ENABLED
+MEMFAULT_STATIC_ASSERT(MEMFAULT_LOG_SPILL_BUFFER_SIZE >=
+                         sizeof(sMfltRamLogEntry) + MEMFAULT_LOG_MAX_LINE_SAVE_LEN,
+                       "MEMFAULT_LOG_SPILL_BUFFER_SIZE must hold a log of the maximum length");
+
+// Holds the logs saved while the log buffer is frozen for an upload and full. Same entry format
+// as the log buffer.
+static uint8_t s_memfault_log_spill_storage[MEMFAULT_LOG_SPILL_BUFFER_SIZE];
+static sMfltCircularBuffer s_memfault_log_spill;
+#endif
+
+#define MEMFAULT_LOG_FILTER_ENABLED \
+  ((MEMFAULT_LOG_DEDUP_WINDOW > 0) || (MEMFAULT_LOG_RATE_LIMIT_BURST > 0))
+
+#if MEMFAULT_LOG_FILTER_ENABLED
+  #if (MEMFAULT_LOG_RATE_LIMIT_BURST > 0) && (MEMFAULT_LOG_LOCKFREE_RING_SIZE > 0)
+    // logs would only be rate limited once moved out of the ring, long after they were saved
+    #error "MEMFAULT_LOG_RATE_LIMIT_BURST can't be used with MEMFAULT_LOG_LOCKFREE_RING_SIZE"
+  #endif
+
+typedef struct {
+  #if MEMFAULT_LOG_DEDUP_WINDOW > 0
+  // Least recently saved or repeated first
+  uint32_t recent_hashes[MEMFAULT_LOG_DEDUP_WINDOW];
+  size_t num_recent_hashes;
+  #endif
+  #if MEMFAULT_LOG_RATE_LIMIT_BURST > 0
+  // In thousandths of a log so the refill of short intervals isn't lost
+  uint32_t tokens[kMemfaultPlatformLogLevel_NumLevels];
+  uint64_t last_refill_ms[kMemfaultPlatformLogLevel_NumLevels];
+  #endif
+  // Logs suppressed since the last log that was saved, and the highest level among them
+  uint32_t repeated_count;
+  uint32_t rate_limited_count;
+  eMemfaultPlatformLogLevel suppressed_level;
+} sMfltLogFilter;
+
+static sMfltLogFilter s_memfault_log_filter;
+#endif
+
 static uint16_t prv_compute_log_region_crc16(void) {
   return memfault_crc16_ccitt_compute(MEMFAULT_CRC16_CCITT_INITIAL_VALUE,
                                       &s_memfault_ram_logger.region_info,
@@ -104,6 +150,32 @@ void memfault_log_set_min_save_level(eMemfaultPlatformLogLevel min_log_level) {
   s_memfault_ram_logger.min_log_level = min_log_level;
 }
 
+#if MEMFAULT_LOG_MODULES_ENABLED
+
+  #define MEMFAULT_LOG_MODULE_DEFINE(module, default_level) (uint8_t)(default_level),
+
+uint8_t g_memfault_log_module_levels[kMfltLogModule_NumModules] = {
+  #include MEMFAULT_LOG_MODULE_USER_DEFS_FILE
+};
+
+  #undef MEMFAULT_LOG_MODULE_DEFINE
+
+void memfault_log_module_set_level(eMfltLogModule module, eMemfaultPlatformLogLevel level) {
+  if ((unsigned)module >= kMfltLogModule_NumModules) {
+    return;
+  }
+  g_memfault_log_module_levels[module] = (uint8_t)level;
+}
+
+eMemfaultPlatformLogLevel memfault_log_module_get_level(eMfltLogModule module) {
+  if ((unsigned)module >= kMfltLogModule_NumModules) {
+    return kMemfaultPlatformLogLevel_NumLevels;
+  }
+  return (eMemfaultPlatformLogLevel)g_memfault_log_module_levels[module];
+}
+
+#endif  // MEMFAULT_LOG_MODULES_ENABLED
+
 static bool prv_try_free_space(sMfltCircularBuffer *circ_bufp, int bytes_needed) {
   const size_t bytes_free = memfault_circular_buffer_get_write_size(circ_bufp);
   bytes_needed -= bytes_free;
@@ -120,11 +192,10 @@ static bool prv_try_free_space(sMfltCircularBuffer *circ_bufp, int bytes_needed)
   }
 
 #if MEMFAULT_LOG_DATA_SOURCE_ENABLED
-  if (memfault_log_data_source_has_been_triggered()) {
-    // Don't allow expiring old logs. memfault_log_trigger_collection() has been
-    // called, so we're in the process of uploading the logs in the buffer.
-    return false;
-  }
+  // memfault_log_trigger_collection() has been called, so we're in the process of uploading logs.
+  // The logs being uploaded are the oldest ones that were not sent yet: only the logs that were
+  // already sent, ahead of them, can be expired.
+  const bool upload_in_progress = memfault_log_data_source_has_been_triggered();
 #endif
 
   // Expire oldest logs until there is enough room available
@@ -132,6 +203,11 @@ static bool prv_try_free_space(sMfltCircularBuffer *circ_bufp, int bytes_needed)
     sMfltRamLogEntry curr_entry = { 0 };
     memfault_circular_buffer_read(circ_bufp, 0, &curr_entry, sizeof(curr_entry));
     const size_t space_to_free = curr_entry.len + sizeof(curr_entry);
+#if MEMFAULT_LOG_DATA_SOURCE_ENABLED
+    if (upload_in_progress && ((curr_entry.hdr & MEMFAULT_LOG_HDR_SENT_MASK) == 0)) {
+      return false;
+    }
+#endif
 
     if ((curr_entry.hdr & MEMFAULT_LOG_HDR_READ_MASK) != 0) {
       s_memfault_ram_logger.log_read_offset -= space_to_free;
@@ -151,6 +227,353 @@ static bool prv_try_free_space(sMfltCircularBuffer *circ_bufp, int bytes_needed)
   return false;  // should be unreachable
 }
 
+#if MEMFAULT_LOG_SPILL_ENABLED
+
+static bool prv_log_spill_copy_cb(void *ctx, MEMFAULT_UNUSED size_t offset, const void *buf,
+                                  size_t buf_len) {
+  return memfault_circular_buffer_write((sMfltCircularBuffer *)ctx, buf, buf_len);
+}
+
+//! Move the logs from the spill buffer to the log buffer once the upload is done
+static void prv_log_spill_merge(void) {
+  if (memfault_log_data_source_has_been_triggered()) {
+    return;
+  }
+
+  sMfltCircularBuffer *circ_bufp = &s_memfault_ram_logger.circ_buffer;
+  sMfltRamLogEntry entry;
+  while (memfault_circular_buffer_read(&s_memfault_log_spill, 0, &entry, sizeof(entry))) {
+    const size_t entry_size = sizeof(entry) + entry.len;
+    if (prv_try_free_space(circ_bufp, (int)entry_size)) {
+      memfault_circular_buffer_write(circ_bufp, &entry, sizeof(entry));
+      memfault_circular_buffer_read_with_callback(&s_memfault_log_spill, sizeof(entry), entry.len,
+                                                  circ_bufp, prv_log_spill_copy_cb);
+    } else {
+      // No room left once the older logs were expired, the spilled log is dropped
+      s_memfault_ram_logger.dropped_msg_count++;
+    }
+    memfault_circular_buffer_consume(&s_memfault_log_spill, entry_size);
+  }
+}
+
+static bool prv_log_spill_write(uint8_t hdr, const void *log, size_t log_len) {
+  // Nothing in the spill buffer is being uploaded so its oldest logs can always be expired
+  while (memfault_circular_buffer_get_write_size(&s_memfault_log_spill) <
+         (sizeof(sMfltRamLogEntry) + log_len)) {
+    sMfltRamLogEntry oldest;
+    if (!memfault_circular_buffer_read(&s_memfault_log_spill, 0, &oldest, sizeof(oldest))) {
+      return false;
+    }
+    memfault_circular_buffer_consume(&s_memfault_log_spill, sizeof(oldest) + oldest.len);
+    s_memfault_ram_logger.dropped_msg_count++;
+  }
+
+  sMfltRamLogEntry entry = {
+    .len = (uint8_t)log_len,
+    .hdr = hdr,
+  };
+  memfault_circular_buffer_write(&s_memfault_log_spill, &entry, sizeof(entry));
+  memfault_circular_buffer_write(&s_memfault_log_spill, log, log_len);
+  return true;
+}
+
+#else
+
+static void prv_log_spill_merge(void) { }
+
+#endif  // MEMFAULT_LOG_SPILL_ENABLED
+
+static bool prv_log_store(uint8_t hdr, const void *log, size_t log_len) {
+  sMfltCircularBuffer *circ_bufp = &s_memfault_ram_logger.circ_buffer;
+#if MEMFAULT_LOG_SPILL_ENABLED
+  prv_log_spill_merge();
+  // Once a log has been spilled, the following ones are spilled as well to keep the order
+  if ((memfault_circular_buffer_get_read_size(&s_memfault_log_spill) != 0) ||
+      !prv_try_free_space(circ_bufp, (int)(sizeof(sMfltRamLogEntry) + log_len))) {
+    return memfault_log_data_source_has_been_triggered() && prv_log_spill_write(hdr, log, log_len);
+  }
+#else
+  if (!prv_try_free_space(circ_bufp, (int)(sizeof(sMfltRamLogEntry) + log_len))) {
+    return false;
+  }
+#endif
+
+  sMfltRamLogEntry entry = {
+    .len = (uint8_t)log_len,
+    .hdr = hdr,
+  };
+  memfault_circular_buffer_write(circ_bufp, &entry, sizeof(entry));
+  memfault_circular_buffer_write(circ_bufp, log, log_len);
+  return true;
+}
+
+#if MEMFAULT_LOG_FILTER_ENABLED
+
+  #if MEMFAULT_LOG_RATE_LIMIT_BURST > 0
+static bool prv_log_rate_limit_take(eMemfaultPlatformLogLevel level) {
+  const uint32_t max_tokens = MEMFAULT_LOG_RATE_LIMIT_BURST * 1000;
+  const uint64_t now_ms = memfault_platform_get_time_since_boot_ms();
+  const uint64_t elapsed_ms = now_ms - s_memfault_log_filter.last_refill_ms[level];
+  s_memfault_log_filter.last_refill_ms[level] = now_ms;
+
+  uint32_t *tokens = &s_memfault_log_filter.tokens[level];
+  const uint64_t refill = elapsed_ms * MEMFAULT_LOG_RATE_LIMIT_PER_SEC;
+  *tokens = (uint32_t)MEMFAULT_MIN((uint64_t)*tokens + refill, max_tokens);
+  if (*tokens < 1000) {
+    return false;
+  }
+  *tokens -= 1000;
+  return true;
+}
+  #endif
+
+  #if MEMFAULT_LOG_DEDUP_WINDOW > 0
+//! Make 'hash' the most recent entry of the dedup window, dropping 'index' (the least recent entry
+//! when the window is full)
+static void prv_log_dedup_window_touch(size_t index, uint32_t hash) {
+  uint32_t *hashes = s_memfault_log_filter.recent_hashes;
+  const size_t num_hashes = s_memfault_log_filter.num_recent_hashes;
+  memmove(&hashes[index], &hashes[index + 1], (num_hashes - index - 1) * sizeof(hashes[0]));
+  hashes[num_hashes - 1] = hash;
+}
+  #endif
+
+//! @return true if the log is a repeat or over the rate limit and must not be saved
+static bool prv_log_filter_suppress(uint8_t hdr, const void *log, size_t log_len) {
+  const eMemfaultPlatformLogLevel level = memfault_log_get_level_from_hdr(hdr);
+  bool suppress = false;
+  #if MEMFAULT_LOG_DEDUP_WINDOW > 0
+  const uint32_t hash = memfault_crc32_compute(
+    memfault_crc32_compute(MEMFAULT_CRC32_INITIAL_VALUE, &hdr, sizeof(hdr)), log, log_len);
+  for (size_t i = 0; i < s_memfault_log_filter.num_recent_hashes; i++) {
+    if (s_memfault_log_filter.recent_hashes[i] == hash) {
+      // keep the logs that repeat the most in the window
+      prv_log_dedup_window_touch(i, hash);
+      s_memfault_log_filter.repeated_count++;
+      suppress = true;
+      break;
+    }
+  }
+  #else
+  (void)log;
+  (void)log_len;
+  #endif
+  #if MEMFAULT_LOG_RATE_LIMIT_BURST > 0
+  if (!suppress && !prv_log_rate_limit_take(level)) {
+    s_memfault_log_filter.rate_limited_count++;
+    suppress = true;
+  }
+  #endif
+
+  if (suppress) {
+    s_memfault_log_filter.suppressed_level =
+      MEMFAULT_MAX(s_memfault_log_filter.suppressed_level, level);
+    return true;
+  }
+
+  #if MEMFAULT_LOG_DEDUP_WINDOW > 0
+  if (s_memfault_log_filter.num_recent_hashes < MEMFAULT_LOG_DEDUP_WINDOW) {
+    s_memfault_log_filter.num_recent_hashes++;
+    s_memfault_log_filter.recent_hashes[s_memfault_log_filter.num_recent_hashes - 1] = hash;
+  } else {
+    prv_log_dedup_window_touch(0, hash);
+  }
+  #endif
+  return false;
+}
+
+//! Save a log reporting the logs suppressed since the last log that was saved
+static void prv_log_filter_flush(void) {
+  if ((s_memfault_log_filter.repeated_count == 0) &&
+      (s_memfault_log_filter.rate_limited_count == 0)) {
+    return;
+  }
+
+  char msg[64];
+  const int rv = snprintf(msg, sizeof(msg), "... suppressed %d repeated, %d rate limited ...",
+                          (int)s_memfault_log_filter.repeated_count,
+                          (int)s_memfault_log_filter.rate_limited_count);
+  const uint8_t hdr =
+    prv_build_header(s_memfault_log_filter.suppressed_level, kMemfaultLogRecordType_Preformatted);
+  s_memfault_log_filter.repeated_count = 0;
+  s_memfault_log_filter.rate_limited_count = 0;
+  s_memfault_log_filter.suppressed_level = kMemfaultPlatformLogLevel_Debug;
+  if (rv > 0) {
+    prv_log_store(hdr, msg, MEMFAULT_MIN((size_t)rv, sizeof(msg) - 1));
+  }
+}
+
+#else
+
+static void prv_log_filter_flush(void) { }
+
+#endif  // MEMFAULT_LOG_FILTER_ENABLED
+
+//! Append a log to the log buffer, expiring the oldest logs if needed. Called with the lock held.
+//! When flush_filter is false the summary of the logs suppressed so far isn't saved, it stays
+//! pending until the next call with flush_filter set.
+static bool prv_log_buffer_write(uint8_t hdr, const void *log, size_t log_len, bool flush_filter) {
+#if MEMFAULT_LOG_FILTER_ENABLED
+  if (prv_log_filter_suppress(hdr, log, log_len)) {
+    return false;
+  }
+  if (flush_filter) {
+    prv_log_filter_flush();
+  }
+#else
+  (void)flush_filter;
+#endif
+  return prv_log_store(hdr, log, log_len);
+}
+
+#if MEMFAULT_LOG_LOCKFREE_RING_SIZE > 0
+
+  #if !defined(__GNUC__)
+    #error "MEMFAULT_LOG_LOCKFREE_RING_SIZE requires the GCC/Clang __atomic builtins"
+  #endif
+
+// Staging ring for saves that don't take memfault_lock(). Producers claim space by advancing
+// 'head' with a compare-and-swap, copy the message and then publish it by storing its header word.
+// The single consumer runs with the lock held (or from the fault handler), moves published logs to
+// the log buffer in order and zeroes the space before handing it back by advancing 'tail'. Space
+// that isn't claimed is therefore always zero, which is what stops the consumer at a log that is
+// still being written.
+//
+// Entry layout: a 32 bit header word followed by the message, padded to a multiple of 4 bytes:
+//  bits 0-7: state (eMfltLogRingEntryState)
+//  bits 8-15: sMfltRamLogEntry.hdr
+//  bits 16-23: message length
+// A log never wraps: when it doesn't fit before the end of the ring, the rest of the ring is
+// claimed as padding as well.
+
+  #define MEMFAULT_LOG_RING_ENTRY_SIZE(log_len) \
+    ((uint32_t)sizeof(uint32_t) + (((uint32_t)(log_len) + 3u) & ~3u))
+
+MEMFAULT_STATIC_ASSERT(
+  (MEMFAULT_LOG_LOCKFREE_RING_SIZE & (MEMFAULT_LOG_LOCKFREE_RING_SIZE - 1)) == 0,
+  "MEMFAULT_LOG_LOCKFREE_RING_SIZE must be a power of two");
+MEMFAULT_STATIC_ASSERT(MEMFAULT_LOG_LOCKFREE_RING_SIZE >=
+                         2 * MEMFAULT_LOG_RING_ENTRY_SIZE(MEMFAULT_LOG_MAX_LINE_SAVE_LEN),
+                       "MEMFAULT_LOG_LOCKFREE_RING_SIZE must hold two logs of the maximum length");
+MEMFAULT_STATIC_ASSERT(__atomic_always_lock_free(sizeof(uint32_t), 0),
+                       "MEMFAULT_LOG_LOCKFREE_RING_SIZE requires lock-free 32 bit atomics");
+
+typedef enum {
+  kMfltLogRingEntryState_Free = 0,
+  kMfltLogRingEntryState_Committed = 1,
+  kMfltLogRingEntryState_Padding = 2,
+} eMfltLogRingEntryState;
+
+typedef struct {
+  // Free running byte counters, the offset in the ring is the counter modulo the ring size
+  uint32_t head;
+  uint32_t tail;
+  // Set while a consumer moves logs to the log buffer, which is then half updated
+  bool draining;
+  uint32_t words[MEMFAULT_LOG_LOCKFREE_RING_SIZE / sizeof(uint32_t)];
+} sMfltLogRing;
+
+static sMfltLogRing s_memfault_log_ring;
+
+static uint32_t *prv_log_ring_slot(uint32_t position) {
+  const uint32_t offset = position % MEMFAULT_LOG_LOCKFREE_RING_SIZE;
+  return &s_memfault_log_ring.words[offset / sizeof(uint32_t)];
+}
+
+//! @return false if the ring doesn't have room for the log
+static bool prv_log_ring_push(uint8_t hdr, const void *log, size_t log_len) {
+  const uint32_t entry_size = MEMFAULT_LOG_RING_ENTRY_SIZE(log_len);
+  uint32_t head = __atomic_load_n(&s_memfault_log_ring.head, __ATOMIC_RELAXED);
+  uint32_t padding_size;
+  do {
+    const uint32_t space_to_end =
+      MEMFAULT_LOG_LOCKFREE_RING_SIZE - (head % MEMFAULT_LOG_LOCKFREE_RING_SIZE);
+    padding_size = (entry_size <= space_to_end) ? 0 : space_to_end;
+    // acquire: the consumer zeroed the space before releasing it
+    const uint32_t tail = __atomic_load_n(&s_memfault_log_ring.tail, __ATOMIC_ACQUIRE);
+    if (((head - tail) + padding_size + entry_size) > MEMFAULT_LOG_LOCKFREE_RING_SIZE) {
+      return false;
+    }
+  } while (!__atomic_compare_exchange_n(&s_memfault_log_ring.head, &head,
+                                        head + padding_size + entry_size, true, __ATOMIC_RELAXED,
+                                        __ATOMIC_RELAXED));
+
+  if (padding_size != 0) {
+    __atomic_store_n(prv_log_ring_slot(head), kMfltLogRingEntryState_Padding, __ATOMIC_RELEASE);
+    head += padding_size;
+  }
+
+  uint32_t *slot = prv_log_ring_slot(head);
+  memcpy(&slot[1], log, log_len);
+  const uint32_t hdr_word =
+    kMfltLogRingEntryState_Committed | ((uint32_t)hdr << 8) | ((uint32_t)log_len << 16);
+  __atomic_store_n(slot, hdr_word, __ATOMIC_RELEASE);
+  return true;
+}
+
+static void prv_log_ring_move_published(bool flush_filter) {
+  uint32_t tail = s_memfault_log_ring.tail;
+  const uint32_t head = __atomic_load_n(&s_memfault_log_ring.head, __ATOMIC_RELAXED);
+  while (tail != head) {
+    uint32_t *slot = prv_log_ring_slot(tail);
+    const uint32_t hdr_word = __atomic_load_n(slot, __ATOMIC_ACQUIRE);
+    uint32_t entry_size;
+    switch ((eMfltLogRingEntryState)(hdr_word & 0xff)) {
+      case kMfltLogRingEntryState_Committed: {
+        const uint8_t len = (uint8_t)(hdr_word >> 16);
+        // the log is dropped if it can't be saved, like a save that takes the lock would
+        prv_log_buffer_write((uint8_t)(hdr_word >> 8), &slot[1], len, flush_filter);
+        entry_size = MEMFAULT_LOG_RING_ENTRY_SIZE(len);
+        break;
+      }
+      case kMfltLogRingEntryState_Padding:
+        entry_size = MEMFAULT_LOG_LOCKFREE_RING_SIZE - (tail % MEMFAULT_LOG_LOCKFREE_RING_SIZE);
+        break;
+      case kMfltLogRingEntryState_Free:
+      default:
+        // claimed but not published yet
+        return;
+    }
+
+    memset(slot, 0, entry_size);
+    tail += entry_size;
+    __atomic_store_n(&s_memfault_log_ring.tail, tail, __ATOMIC_RELEASE);
+  }
+}
+
+//! Move the published logs to the log buffer, stopping at the first one still being written.
+//! Must only be called by one context at a time, i.e with the lock held. See
+//! prv_log_buffer_write() for flush_filter.
+static void prv_log_ring_drain(bool flush_filter) {
+  __atomic_store_n(&s_memfault_log_ring.draining, true, __ATOMIC_SEQ_CST);
+  prv_log_ring_move_published(flush_filter);
+  __atomic_store_n(&s_memfault_log_ring.draining, false, __ATOMIC_SEQ_CST);
+}
+
+//! Drain from the fault handler. Skipped if the fault interrupted a drain: the entry at 'tail' may
+//! already be in the log buffer, which may be half updated, so both are left as they are.
+static void prv_log_ring_drain_from_fault(void) {
+  if (!__atomic_load_n(&s_memfault_log_ring.draining, __ATOMIC_SEQ_CST)) {
+    prv_log_ring_drain(false);
+  }
+}
+
+#else
+
+static void prv_log_ring_drain(MEMFAULT_UNUSED bool flush_filter) { }
+
+static void prv_log_ring_drain_from_fault(void) { }
+
+#endif  // MEMFAULT_LOG_LOCKFREE_RING_SIZE > 0
+
+void memfault_log_flush_pending_nolock(void) {
+  if (s_memfault_ram_logger.enabled) {
+    // From the fault handler: only move the logs, formatting the summary of the suppressed logs is
+    // left to the next log saved
+    prv_log_ring_drain_from_fault();
+  }
+}
+
 static void prv_iterate(MemfaultLogIteratorCallback callback, sMfltLogIterator *iter) {
   sMfltCircularBuffer *const circ_bufp = &s_memfault_ram_logger.circ_buffer;
   bool should_continue = true;
@@ -172,6 +595,9 @@ static void prv_iterate(MemfaultLogIteratorCallback callback, sMfltLogIterator *
 
 void memfault_log_iterate(MemfaultLogIteratorCallback callback, sMfltLogIterator *iter) {
   memfault_lock();
+  prv_log_spill_merge();
+  prv_log_ring_drain(true);
+  prv_log_filter_flush();
   prv_iterate(callback, iter);
   memfault_unlock();
 }
@@ -247,6 +673,9 @@ bool memfault_log_read(sMemfaultLog *log) {
   }
 
   memfault_lock();
+  prv_log_spill_merge();
+  prv_log_ring_drain(true);
+  prv_log_filter_flush();
   const bool found_unread_log = prv_read_log(log);
   memfault_unlock();
 
@@ -383,24 +812,32 @@ static void prv_log_save(eMemfaultPlatformLogLevel level, const void *log, size_
     return;
   }
 
-  bool log_written = false;
+  bool log_written;
   const size_t truncated_log_len = MEMFAULT_MIN(log_len, MEMFAULT_LOG_MAX_LINE_SAVE_LEN);
-  const size_t bytes_needed = sizeof(sMfltRamLogEntry) + truncated_log_len;
+  const uint8_t hdr = prv_build_header(level, log_type);
+#if MEMFAULT_LOG_LOCKFREE_RING_SIZE > 0
+  if (prv_log_ring_push(hdr, log, truncated_log_len)) {
+    memfault_log_handle_saved_callback();
+    return;
+  }
+#endif
+
   if (should_lock) {
     memfault_lock();
   }
   {
-    sMfltCircularBuffer *circ_bufp = &s_memfault_ram_logger.circ_buffer;
-    const bool space_free = prv_try_free_space(circ_bufp, (int)bytes_needed);
-    if (space_free) {
-      sMfltRamLogEntry entry = {
-        .len = (uint8_t)truncated_log_len,
-        .hdr = prv_build_header(level, log_type),
-      };
-      memfault_circular_buffer_write(circ_bufp, &entry, sizeof(entry));
-      memfault_circular_buffer_write(circ_bufp, log, truncated_log_len);
-      log_written = true;
+#if MEMFAULT_LOG_LOCKFREE_RING_SIZE > 0
+    // The ring is full. Make room by moving its logs to the log buffer and queue behind the ones
+    // still being written. If the ring is still full the log is dropped: writing it directly would
+    // put it ahead of logs that were saved before it.
+    prv_log_ring_drain(true);
+    log_written = prv_log_ring_push(hdr, log, truncated_log_len);
+    if (!log_written) {
+      s_memfault_ram_logger.dropped_msg_count++;
     }
+#else
+    log_written = prv_log_buffer_write(hdr, log, truncated_log_len, true);
+#endif
   }
   if (should_lock) {
     memfault_unlock();
@@ -463,6 +900,15 @@ bool memfault_log_boot(void *storage_buffer, size_t buffer_len) {
   s_memfault_ram_logger.region_info.crc16 = prv_compute_log_region_crc16();
 
   memfault_circular_buffer_init(&s_memfault_ram_logger.circ_buffer, storage_buffer, buffer_len);
+#if MEMFAULT_LOG_SPILL_ENABLED
+  memfault_circular_buffer_init(&s_memfault_log_spill, s_memfault_log_spill_storage,
+                                sizeof(s_memfault_log_spill_storage));
+#endif
+#if MEMFAULT_LOG_RATE_LIMIT_BURST > 0
+  for (size_t i = 0; i < MEMFAULT_ARRAY_SIZE(s_memfault_log_filter.tokens); i++) {
+    s_memfault_log_filter.tokens[i] = MEMFAULT_LOG_RATE_LIMIT_BURST * 1000;
+  }
+#endif
 
   // finally, enable logging
   s_memfault_ram_logger.enabled = true;
@@ -473,6 +919,15 @@ void memfault_log_reset(void) {
   s_memfault_ram_logger = (sMfltRamLogger){
     .enabled = false,
   };
+#if MEMFAULT_LOG_LOCKFREE_RING_SIZE > 0
+  s_memfault_log_ring = (sMfltLogRing){ 0 };
+#endif
+#if MEMFAULT_LOG_SPILL_ENABLED
+  s_memfault_log_spill = (sMfltCircularBuffer){ 0 };
+#endif
+#if MEMFAULT_LOG_FILTER_ENABLED
+  s_memfault_log_filter = (sMfltLogFilter){ 0 };
+#endif
 }
 
 bool memfault_log_booted(void) {
@@ -424,6 +424,28 @@ uint32_t memfault_self_test_coredump_storage_test(void) {
   return result ? 0 : (1 << 2);
 }
 
+uint32_t memfault_self_test_coredump_storage_profile_test(void) {
+  MEMFAULT_SELF_TEST_PRINT_HEADER("Coredump Storage Profile");
+
+  if (memfault_coredump_has_valid_coredump(NULL)) {
+    MEMFAULT_LOG_ERROR("Aborting test, valid coredump present");
+    MEMFAULT_LOG_INFO(MEMFAULT_SELF_TEST_END_OUTPUT);
+    return (1 << 0);
+  }
+
+  // Interrupts stay enabled so the time since boot keeps advancing
+  sMemfaultCoredumpStorageProfile profile;
+  if (memfault_coredump_storage_debug_profile(&profile)) {
+    memfault_coredump_storage_debug_profile_print(&profile);
+  }
+
+  // Reports any storage failure and leaves storage cleared
+  bool result = memfault_coredump_storage_debug_test_finish();
+
+  MEMFAULT_LOG_INFO(MEMFAULT_SELF_TEST_END_OUTPUT);
+  return result ? 0 : (1 << 1);
+}
+
 #endif  // defined(MEMFAULT_UNITTEST_SELF_TEST)
 
 int memfault_self_test_run(uint32_t run_flags) {
@@ -456,6 +478,15 @@ int memfault_self_test_run(uint32_t run_flags) {
     MEMFAULT_LOG_ERROR("Coredump storage test not enabled");
     MEMFAULT_LOG_ERROR(MEMFAULT_SELF_TEST_COREDUMP_STORAGE_DISABLE_MSG);
     result = 1;
+#endif
+  }
+  if (run_flags & kMemfaultSelfTestFlag_CoredumpStorageProfile) {
+#if MEMFAULT_DEMO_CLI_SELF_TEST_COREDUMP_STORAGE
+    result |= memfault_self_test_coredump_storage_profile_test();
+#else
+    MEMFAULT_LOG_ERROR("Coredump storage profile not enabled");
+    MEMFAULT_LOG_ERROR(MEMFAULT_SELF_TEST_COREDUMP_STORAGE_DISABLE_MSG);
+    result = 1;
 #endif
   }
   if (run_flags & kMemfaultSelfTestFlag_CoredumpStorageCapacity) {
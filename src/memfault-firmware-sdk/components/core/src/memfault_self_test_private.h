@@ -69,6 +69,12 @@ uint32_t memfault_self_test_coredump_storage_test(void);
 //! Runs test to check capacity of coredump storage against worst case
 uint32_t memfault_self_test_coredump_storage_capacity_test(void);
 
+//! Measures erase, write and read throughput of the platform coredump storage implementation and
+//! predicts how long a coredump save takes
+//!
+//! Like memfault_self_test_coredump_storage_test(), this aborts if a valid coredump is present
+uint32_t memfault_self_test_coredump_storage_profile_test(void);
+
 //! Internal implementation of strnlen
 //!
 //! Support for strnlen is inconsistent across a lot of libc implementations so we implement this
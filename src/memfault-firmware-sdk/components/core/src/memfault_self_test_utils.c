@@ -41,6 +41,10 @@ static const struct {
     .name = "coredump_storage",
     .value = kMemfaultSelfTestFlag_CoredumpStorage,
   },
+  {
+    .name = "coredump_storage_profile",
+    .value = kMemfaultSelfTestFlag_CoredumpStorageProfile,
+  },
 };
 
 #define SELF_TEST_MAX_NAME_LEN 30
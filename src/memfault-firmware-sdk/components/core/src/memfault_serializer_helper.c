@@ -205,17 +205,19 @@ bool memfault_serializer_helper_encode_to_storage(
   sMemfaultCborEncoder *encoder, const sMemfaultEventStorageImpl *storage_impl,
   MemfaultSerializerHelperEncodeCallback encode_callback, void *ctx) {
   const size_t space_available = storage_impl->begin_write_cb();
-  bool success;
-  {
+  bool success = false;
+  // nothing to finish if storage is full or busy with another event, the event is dropped
+  if (space_available != 0) {
     sMemfaultSerializerHelperEncoderCtx encoder_ctx = {
       .storage_impl = storage_impl,
     };
     memfault_cbor_encoder_init(encoder, prv_encoder_write_cb, &encoder_ctx, space_available);
     success = encode_callback(encoder, ctx);
     memfault_cbor_encoder_deinit(encoder);
+
+    const bool rollback = !success;
+    storage_impl->finish_write_cb(rollback);
   }
-  const bool rollback = !success;
-  storage_impl->finish_write_cb(rollback);
 
   if (!success) {
     if (s_num_storage_drops == 0) {
@@ -246,6 +248,22 @@ size_t memfault_serializer_helper_compute_size(
   return memfault_cbor_encoder_deinit(encoder);
 }
 
+static bool prv_encode_metadata_worst_case_cb(sMemfaultCborEncoder *encoder, void *ctx) {
+  // the capture time is only encoded when available, assume it is
+  const sMemfaultCurrentTime time = {
+    .type = kMemfaultCurrentTimeType_UnixEpochTimeSec,
+    .info = { .unix_timestamp_secs = UINT32_MAX },
+  };
+  return memfault_serializer_helper_encode_metadata_with_time(
+    encoder, *(const eMemfaultEventType *)ctx, &time);
+}
+
+size_t memfault_serializer_helper_compute_metadata_worst_case_size(eMemfaultEventType type) {
+  sMemfaultCborEncoder encoder = { 0 };
+  return memfault_serializer_helper_compute_size(&encoder, prv_encode_metadata_worst_case_cb,
+                                                 &type);
+}
+
 bool memfault_serializer_helper_check_storage_size(const sMemfaultEventStorageImpl *storage_impl,
                                                    size_t(compute_worst_case_size)(void),
                                                    const char *event_type) {
@@ -109,7 +109,7 @@ int memfault_demo_cli_cmd_get_core(MEMFAULT_UNUSED int argc, MEMFAULT_UNUSED cha
 
 int memfault_demo_cli_cmd_clear_core(MEMFAULT_UNUSED int argc, MEMFAULT_UNUSED char *argv[]) {
   MEMFAULT_LOG_INFO("Invalidating coredump");
-  memfault_platform_coredump_storage_clear();
+  memfault_coredump_storage_clear_all();
   return 0;
 }
 
@@ -53,10 +53,27 @@ typedef bool(MemfaultDataSourceReadMessageCallback)(uint32_t offset, void *buf,
 //! a info about a new message or nothing if there are no more messages to read
 typedef void(MemfaultDataSourceMarkMessageReadCallback)(void);
 
+//! Optional: Get a pointer to the bytes of the currently queued up message
+//!
+//! Data sources whose backing storage is memory mapped can implement this so the bytes are
+//! consumed in place (i.e by the RLE encoder) instead of first being copied out with the
+//! MemfaultDataSourceReadMessageCallback
+//!
+//! @param offset The offset to begin reading at
+//! @param read_ptr Populated with a pointer to the message data at offset
+//! @param read_ptr_len Populated with the number of bytes which can be read from read_ptr
+//!
+//! @return true if a pointer was returned, false if the data must be read with the
+//!  MemfaultDataSourceReadMessageCallback instead
+typedef bool(MemfaultDataSourceGetReadPointerCallback)(uint32_t offset, const void **read_ptr,
+                                                       size_t *read_ptr_len);
+
 typedef struct MemfaultDataSourceImpl {
   MemfaultDataSourceHasMoreMessagesCallback *has_more_msgs_cb;
   MemfaultDataSourceReadMessageCallback *read_msg_cb;
   MemfaultDataSourceMarkMessageReadCallback *mark_msg_read_cb;
+  //! Optional, may be NULL
+  MemfaultDataSourceGetReadPointerCallback *get_read_pointer_cb;
 } sMemfaultDataSourceImpl;
 
 //! "Coredump" data source provided as part of "panics" component
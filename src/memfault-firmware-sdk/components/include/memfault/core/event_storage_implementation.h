@@ -24,7 +24,9 @@ struct MemfaultEventStorageImpl {
   //!
   //! @note To close the session, memfault_events_storage_finish_write() must be called
   //!
-  //! @return the free space in storage for the write
+  //! @return the free space in storage for the write, 0 if no session could be opened because
+  //!  storage is full or another event is being written. finish_write_cb() must not be called
+  //!  in that case.
   size_t (*begin_write_cb)(void);
 
   //! Called to append more data to the current event
@@ -219,9 +219,11 @@ void memfault_vlog_save(eMemfaultPlatformLogLevel level, const char *fmt, va_lis
 //! Freezes the contents of the log buffer in preparation of uploading the logs to Memfault.
 //!
 //! Once the log buffer contents have been uploaded, the buffer is unfrozen. While the buffer is
-//! frozen, logs can still be added, granted enough space is available in the buffer. If the buffer
-//! is full, newly logs will get dropped. Once the buffer is unfrozen again, the oldest logs will be
-//! expunged again upon writing new logs that require the space.
+//! frozen, logs can still be added, granted enough space is available in the buffer. Logs that
+//! were already sent are still expunged to make room, but the logs being uploaded are kept. If
+//! there is no room left, new logs go to the MEMFAULT_LOG_SPILL_BUFFER_SIZE spill buffer, or are
+//! dropped when it is disabled. Once the buffer is unfrozen again, the spilled logs are moved back
+//! and the oldest logs will be expunged again upon writing new logs that require the space.
 //! @note This function must not be called from an ISR context.
 void memfault_log_trigger_collection(void);
 
@@ -38,6 +38,15 @@ typedef struct {
 //!   to get decoded in a coredump (https://mflt.io/logging)
 bool memfault_log_get_regions(sMemfaultLogRegions *regions);
 
+//! Move the logs saved to the MEMFAULT_LOG_LOCKFREE_RING_SIZE staging ring into the log buffer
+//! without taking memfault_lock()
+//!
+//! @note Internal function called from the fault handler before the log regions are collected.
+//! No-op when the staging ring is disabled, or when the fault interrupted a move of the ring to
+//! the log buffer. The summary of the logs suppressed by MEMFAULT_LOG_DEDUP_WINDOW isn't saved
+//! from here, it is saved before the next log instead.
+void memfault_log_flush_pending_nolock(void);
+
 #ifdef __cplusplus
 }
 #endif
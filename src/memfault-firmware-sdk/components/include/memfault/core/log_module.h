@@ -0,0 +1,122 @@
+#pragma once
+
+//! @file
+//!
+//! Copyright (c) Memfault, Inc.
+//! See License.txt for details
+//!
+//! @brief
+//! Per-module filtering for logs saved with the memfault/core/log.h module.
+//!
+//! Each module is declared once in a user .def file and gets its own runtime save level. Calls
+//! below MEMFAULT_LOG_MODULE_COMPILED_MIN_LEVEL are removed at compile time, and calls below the
+//! module's runtime level return before any of the arguments are evaluated or formatted.
+//!
+//! NOTE: Like the MEMFAULT_TRACE_REASON APIs, the module list makes use of "X-Macros".
+
+#include <stdint.h>
+
+#include "memfault-firmware-sdk/components/include/memfault/config.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/compiler.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/log.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if MEMFAULT_LOG_MODULES_ENABLED
+
+//! Defines a log module.
+//!
+//! Log modules are expected to be defined in a separate *.def file, which is picked up via the
+//! MEMFAULT_LOG_MODULE_USER_DEFS_FILE preprocessor definition (by default
+//! "memfault_log_module_config.def"). Please ensure the file can be found in the header search
+//! paths.
+//!
+//! The contents of the .def file could look like:
+//!
+//! // memfault_log_module_config.def
+//! MEMFAULT_LOG_MODULE_DEFINE(wifi, kMemfaultPlatformLogLevel_Info)
+//! MEMFAULT_LOG_MODULE_DEFINE(sensor, kMemfaultPlatformLogLevel_Warning)
+//!
+//! @param module The name of the module, without quotes. It is prepended to every log saved for
+//! the module, i.e "[wifi] ...". C variable naming rules apply.
+//! @param default_level The eMemfaultPlatformLogLevel the module saves logs at after boot
+//! @note module must be unique
+  #define MEMFAULT_LOG_MODULE_DEFINE(module, default_level) kMfltLogModule_##module,
+
+//! For compilers which support the __has_include macro display a more friendly error message
+//! when the user defined header is not found on the include path
+//!
+//! NB: ARMCC and IAR define __has_include but they don't work as expected
+  #if !defined(__CC_ARM) && !defined(__ICCARM__)
+    #if defined(__has_include) && !__has_include(MEMFAULT_LOG_MODULE_USER_DEFS_FILE)
+      #pragma message("ERROR: " MEMFAULT_EXPAND_AND_QUOTE( \
+        MEMFAULT_LOG_MODULE_USER_DEFS_FILE) " must be in header search path")
+      #error "See log_module.h for more details"
+    #endif
+  #endif
+
+typedef enum MfltLogModule {
+  #include MEMFAULT_LOG_MODULE_USER_DEFS_FILE
+
+  kMfltLogModule_NumModules,
+} eMfltLogModule;
+
+  #undef MEMFAULT_LOG_MODULE_DEFINE
+
+//! Uses a log module defined with MEMFAULT_LOG_MODULE_DEFINE.
+//! @param module The name of the module, without quotes.
+  #define MEMFAULT_LOG_MODULE(module) kMfltLogModule_##module
+
+//! The current save level of each module, indexed by eMfltLogModule
+//!
+//! @note Only exposed so the MEMFAULT_LOG_MODULE_SAVE check can be inlined at the call site. Use
+//! memfault_log_module_set_level() to change a level.
+extern uint8_t g_memfault_log_module_levels[kMfltLogModule_NumModules];
+
+//! Saves a log for the given module
+//!
+//! The log is saved through MEMFAULT_LOG_SAVE, so it uses the normal or compact form depending on
+//! SDK configuration. For compact logs the "[module] " prefix only lives in the log_fmt ELF
+//! section, so it costs no space on the device.
+//!
+//! @param module The name of the module, without quotes, as defined using
+//! MEMFAULT_LOG_MODULE_DEFINE.
+//! @param level The eMemfaultPlatformLogLevel of the log
+//! @param format A string literal format string, followed by any arguments
+//!
+//! @note If level is below MEMFAULT_LOG_MODULE_COMPILED_MIN_LEVEL or the module's current level,
+//! none of the arguments are evaluated. The global memfault_log_set_min_save_level() level is
+//! still applied on top of the module level.
+  #define MEMFAULT_LOG_MODULE_SAVE(module, level, format, ...)                           \
+    do {                                                                                  \
+      if (((level) >= MEMFAULT_LOG_MODULE_COMPILED_MIN_LEVEL) &&                          \
+          ((level) >= g_memfault_log_module_levels[MEMFAULT_LOG_MODULE(module)])) {       \
+        MEMFAULT_LOG_SAVE(level, "[" #module "] " format, ##__VA_ARGS__);                 \
+      }                                                                                   \
+    } while (0)
+
+  #define MEMFAULT_LOG_MODULE_DEBUG(module, ...) \
+    MEMFAULT_LOG_MODULE_SAVE(module, kMemfaultPlatformLogLevel_Debug, __VA_ARGS__)
+  #define MEMFAULT_LOG_MODULE_INFO(module, ...) \
+    MEMFAULT_LOG_MODULE_SAVE(module, kMemfaultPlatformLogLevel_Info, __VA_ARGS__)
+  #define MEMFAULT_LOG_MODULE_WARN(module, ...) \
+    MEMFAULT_LOG_MODULE_SAVE(module, kMemfaultPlatformLogLevel_Warning, __VA_ARGS__)
+  #define MEMFAULT_LOG_MODULE_ERROR(module, ...) \
+    MEMFAULT_LOG_MODULE_SAVE(module, kMemfaultPlatformLogLevel_Error, __VA_ARGS__)
+
+//! Change the minimum level saved for a module
+//!
+//! @note Levels below MEMFAULT_LOG_MODULE_COMPILED_MIN_LEVEL were removed at compile time and
+//! can not be re-enabled at runtime.
+void memfault_log_module_set_level(eMfltLogModule module, eMemfaultPlatformLogLevel level);
+
+//! @return The minimum level currently saved for a module
+eMemfaultPlatformLogLevel memfault_log_module_get_level(eMfltLogModule module);
+
+#endif /* MEMFAULT_LOG_MODULES_ENABLED */
+
+#ifdef __cplusplus
+}
+#endif
@@ -24,6 +24,7 @@ typedef enum {
   kMemfaultSelfTestFlag_PlatformTime = (1 << 6),
   kMemfaultSelfTestFlag_CoredumpStorage = (1 << 7),
   kMemfaultSelfTestFlag_CoredumpStorageCapacity = (1 << 8),
+  kMemfaultSelfTestFlag_CoredumpStorageProfile = (1 << 9),
 
   // A convenience mask which runs the default tests
   kMemfaultSelfTestFlag_Default =
@@ -66,6 +66,11 @@ bool memfault_serializer_helper_encode_to_storage(
 size_t memfault_serializer_helper_compute_size(
   sMemfaultCborEncoder *encoder, MemfaultSerializerHelperEncodeCallback encode_callback, void *ctx);
 
+//! Compute the worst case size of the metadata encoded at the start of every event by
+//! memfault_serializer_helper_encode_metadata(). Only the metadata is encoded, so the cost does
+//! not depend on the size of the event.
+size_t memfault_serializer_helper_compute_metadata_worst_case_size(eMemfaultEventType type);
+
 bool memfault_serializer_helper_check_storage_size(const sMemfaultEventStorageImpl *storage_impl,
                                                    size_t(compute_worst_case_size)(void),
                                                    const char *event_type);
@@ -42,6 +42,7 @@ typedef enum {
 typedef enum {
   kMemfaultHeartbeatInfoKey_Metrics = 1,
   kMemfaultHeartbeatInfoKey_Session = 2,
+  kMemfaultHeartbeatInfoKey_SparseMetrics = 3,
 } eMemfaultHeartbeatInfoKey;
 
 //! EventInfo dictionary keys for events with type kMemfaultEventType_Trace.
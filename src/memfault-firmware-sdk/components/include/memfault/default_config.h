@@ -129,6 +129,68 @@ extern "C" {
   #define MEMFAULT_LOG_MAX_LINE_SAVE_LEN 128
 #endif
 
+//! Size in bytes of a staging ring that logs are saved to without taking memfault_lock(). With
+//! the default of 0, every save takes the lock and writes to the log buffer directly.
+//!
+//! Saved logs are moved to the log buffer by the next reader (memfault_log_read(), log
+//! collection) or by a save that finds the ring full. If the ring is still full after that, the
+//! logs saved before are still being written and the log is dropped. Each log takes 4 bytes plus
+//! its length rounded up to 4 bytes. Must be a power of two large enough for two logs of
+//! MEMFAULT_LOG_MAX_LINE_SAVE_LEN. Requires the GCC/Clang __atomic builtins and a lock-free 32 bit
+//! compare-and-swap, so it can't be used on ARMv6-M (i.e Cortex-M0/M0+).
+#ifndef MEMFAULT_LOG_LOCKFREE_RING_SIZE
+  #define MEMFAULT_LOG_LOCKFREE_RING_SIZE 0
+#endif
+
+//! Size in bytes of a buffer that takes the logs saved while the log buffer is frozen for an
+//! upload (see memfault_log_trigger_collection()) and has no room left. Its oldest logs are
+//! expired when it fills up. The logs are moved back to the log buffer once the upload is done,
+//! until then they can't be read and aren't part of coredumps. With the default of 0, those logs
+//! are dropped. Must fit at least one log of MEMFAULT_LOG_MAX_LINE_SAVE_LEN (plus 2 bytes).
+#ifndef MEMFAULT_LOG_SPILL_BUFFER_SIZE
+  #define MEMFAULT_LOG_SPILL_BUFFER_SIZE 0
+#endif
+
+//! Number of recent logs a new log is compared against, by a CRC32 of its level, type and
+//! message. A log matching one of them is counted instead of being saved again, so a log repeated
+//! in a loop doesn't push the history out of the buffer. The count is saved as a "... suppressed N
+//! repeated, M rate limited ..." log before the next log that is saved, or when logs are read.
+//! The logs that were saved or repeated the longest ago leave the window first. 1 only catches
+//! repeats of the previous log. 0 (the default) disables it.
+#ifndef MEMFAULT_LOG_DEDUP_WINDOW
+  #define MEMFAULT_LOG_DEDUP_WINDOW 0
+#endif
+
+//! Rate limit saved logs with a token bucket per log level: a level can save bursts of
+//! MEMFAULT_LOG_RATE_LIMIT_BURST logs, refilled at MEMFAULT_LOG_RATE_LIMIT_PER_SEC logs per
+//! second. Logs over the limit are counted and reported like the ones suppressed by
+//! MEMFAULT_LOG_DEDUP_WINDOW. A burst of 0 (the default) disables it. Uses
+//! memfault_platform_get_time_since_boot_ms() and can't be combined with
+//! MEMFAULT_LOG_LOCKFREE_RING_SIZE.
+#ifndef MEMFAULT_LOG_RATE_LIMIT_BURST
+  #define MEMFAULT_LOG_RATE_LIMIT_BURST 0
+#endif
+
+#ifndef MEMFAULT_LOG_RATE_LIMIT_PER_SEC
+  #define MEMFAULT_LOG_RATE_LIMIT_PER_SEC 10
+#endif
+
+//! Enables per-module log levels, see memfault/core/log_module.h. The modules are defined in
+//! MEMFAULT_LOG_MODULE_USER_DEFS_FILE, which must be in the header search path when enabled.
+#ifndef MEMFAULT_LOG_MODULES_ENABLED
+  #define MEMFAULT_LOG_MODULES_ENABLED 0
+#endif
+
+#ifndef MEMFAULT_LOG_MODULE_USER_DEFS_FILE
+  #define MEMFAULT_LOG_MODULE_USER_DEFS_FILE "memfault_log_module_config.def"
+#endif
+
+//! MEMFAULT_LOG_MODULE_SAVE() calls below this level are removed at compile time, along with
+//! their format strings and arguments. By default nothing is removed.
+#ifndef MEMFAULT_LOG_MODULE_COMPILED_MIN_LEVEL
+  #define MEMFAULT_LOG_MODULE_COMPILED_MIN_LEVEL kMemfaultPlatformLogLevel_Debug
+#endif
+
 //! Control whether or automatic persisting of MEMFAULT_LOG_*'s is enabled
 #ifndef MEMFAULT_SDK_LOG_SAVE_DISABLE
   #define MEMFAULT_SDK_LOG_SAVE_DISABLE 0
@@ -211,6 +273,136 @@ extern "C" {
   #define MEMFAULT_MESSAGE_HEADER_CONTAINS_PROJECT_KEY 0
 #endif
 
+//
+// Coredump Configuration
+//
+
+//! Controls write combining for coredump storage writes
+//!
+//! When set to 0 (default), every block written while saving a coredump results in a call to
+//! memfault_platform_coredump_storage_write(), including one call per 32-bit word for
+//! kMfltCoredumpRegionType_MemoryWordAccessOnly regions.
+//!
+//! When set to a non-zero value (typically the storage page/program size), writes are staged in a
+//! statically allocated, word aligned buffer of this size and flushed in chunks which never cross
+//! a multiple of this size within coredump storage. This is useful for storage drivers with a
+//! large fixed cost per write. Must be a multiple of 4.
+#ifndef MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE
+  #define MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE 0
+#endif
+
+//! Controls how coredump storage is erased when a coredump is saved
+//!
+//! When set to 0 (default), the entire coredump storage partition is erased before any data is
+//! written. When set to 1, sectors are erased one at a time just ahead of the offset being
+//! written, so only the space the coredump actually needs is erased from the fault handler.
+//! Requires sMfltCoredumpStorageInfo.sector_size to be populated by the platform port.
+#ifndef MEMFAULT_COREDUMP_STORAGE_ERASE_LAZY
+  #define MEMFAULT_COREDUMP_STORAGE_ERASE_LAZY 0
+#endif
+
+//! Enables memfault_coredump_storage_pre_erase_step(), which can be called from an idle task to
+//! erase coredump storage in the background once a coredump has been uploaded. When a pre-erase
+//! has completed since boot, no erasing is performed from the fault handler at all.
+#ifndef MEMFAULT_COREDUMP_STORAGE_PRE_ERASE
+  #define MEMFAULT_COREDUMP_STORAGE_PRE_ERASE 0
+#endif
+
+//! The number of coredumps which can be held in coredump storage at once
+//!
+//! By default, storage holds a single coredump and no new coredump is saved until it has been
+//! drained. When set to a value greater than 1 (up to 32), storage is split into this many
+//! equally sized, sector aligned slots. A crash is saved to the first free slot and slots are
+//! drained and cleared independently, so the first N crashes of a crash loop are kept.
+#ifndef MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS
+  #define MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS 1
+#endif
+
+//! Controls how regions are truncated when coredump storage is too small to hold all of them
+//!
+//! When set to 0 (default), regions are written in order and the region which reaches the end of
+//! storage is truncated, with any regions after it dropped.
+//!
+//! When set to 1, storage is budgeted before anything is written. First the guaranteed_size of
+//! each region is allocated in priority order (see sMfltCoredumpRegion), then the remainder of
+//! each region in priority order. Regions are still written in their original order.
+#ifndef MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED
+  #define MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED 0
+#endif
+
+//! The maximum number of regions (arch, SDK and platform regions combined) the coredump region
+//! planner can budget for. Regions past this limit are dropped. Costs 4 bytes of RAM per region.
+#ifndef MEMFAULT_COREDUMP_REGION_PLANNER_MAX_REGIONS
+  #define MEMFAULT_COREDUMP_REGION_PLANNER_MAX_REGIONS 32
+#endif
+
+//! Controls whether memory regions are compressed as they are written to coredump storage
+//!
+//! When enabled, each memory region is run length encoded while it is saved and stored as a
+//! kMfltCoredumpRegionType_MemoryRegionRle block whenever that is smaller than the raw region, so
+//! more RAM fits in the same partition. The encoder state is a few dozen bytes of static RAM and
+//! the region is read twice (once to size the block, once to write it). Coredumps are then no
+//! longer run length encoded again at upload time.
+//!
+//! Encoded sequences are written a few bytes at a time so enabling
+//! MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE as well is recommended.
+//!
+//! Note: memfault_coredump_storage_compute_size_required() still reports the uncompressed size
+//! since it is a worst case bound.
+//!
+//! Warning: kMfltCoredumpRegionType_MemoryRegionRle is a new coredump block type. Only enable this
+//! once the Memfault cloud decodes it, since coredump ingestion without that support can't
+//! recover the compressed regions.
+#ifndef MEMFAULT_COREDUMP_COMPRESS_REGIONS
+  #define MEMFAULT_COREDUMP_COMPRESS_REGIONS 0
+#endif
+
+//! The word unused thread stack is filled with. Used to find the part of a
+//! kMfltCoredumpRegionType_ThreadStack region which needs to be saved.
+#ifndef MEMFAULT_COREDUMP_STACK_FILL_WORD
+  #define MEMFAULT_COREDUMP_STACK_FILL_WORD 0xa5a5a5a5
+#endif
+
+//! Controls whether coredumps are saved with CRC32 checksums so corruption can be detected on
+//! the device
+//!
+//! When enabled, a kMfltCoredumpRegionType_Crc32 block follows each region (and the blocks
+//! ahead of the regions), costing 16 bytes of storage each. memfault_coredump_verify_step() can
+//! then check a saved coredump incrementally, i.e from an idle task. The coredump data source
+//! also checks up to MEMFAULT_COREDUMP_VERIFY_BYTES_PER_POLL bytes each time it is polled, and
+//! only reports the coredump once the check has completed. The result is kept until the coredump
+//! is drained. A coredump which fails the check is logged and discarded rather than uploaded.
+//!
+//! Warning: kMfltCoredumpRegionType_Crc32 is a new coredump block type. Only enable this once the
+//! Memfault cloud decodes it, since coredump ingestion without that support doesn't skip it.
+#ifndef MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+  #define MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED 0
+#endif
+
+//! The most bytes of a coredump the coredump data source CRC32 checks each time it is polled,
+//! which bounds the storage reads a packetizer poll can trigger
+#ifndef MEMFAULT_COREDUMP_VERIFY_BYTES_PER_POLL
+  #define MEMFAULT_COREDUMP_VERIFY_BYTES_PER_POLL 4096
+#endif
+
+//! Size of a retained RAM buffer coredumps are saved to from the fault handler
+//!
+//! When set to 0 (default), memfault_coredump_save() writes straight to coredump storage. When
+//! non-zero, memfault_coredump_save() copies the coredump into a buffer of this size instead so
+//! handling a fault only costs a memcpy of the regions. After the reboot,
+//! memfault_coredump_snapshot_commit() moves the snapshot into coredump storage (compressing
+//! regions if MEMFAULT_COREDUMP_COMPRESS_REGIONS is enabled) and should be called from a
+//! background task. Must be a multiple of 4.
+#ifndef MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE
+  #define MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE 0
+#endif
+
+//! Controls the section name used for the RAM snapshot buffer. The section must not be
+//! initialized on boot (see memfault_platform_ram_backed_coredump.c for a linker script example)
+#ifndef MEMFAULT_COREDUMP_RAM_SNAPSHOT_SECTION_NAME
+  #define MEMFAULT_COREDUMP_RAM_SNAPSHOT_SECTION_NAME ".noinit.mflt_coredump_snapshot"
+#endif
+
 //
 // Heap Statistics Configuration
 //
@@ -335,6 +527,72 @@ extern "C" {
   #define MEMFAULT_METRICS_BATTERY_ENABLE 0
 #endif
 
+//! Encode heartbeat and session metrics as a map of { position in session: value } that leaves
+//! out integer metrics which were never set and histograms with no samples, instead of an array
+//! holding every metric with null for the unset ones. This shrinks heartbeats where only a few
+//! of many defined metrics are updated, at the cost of a larger worst-case size when every
+//! metric is set.
+#ifndef MEMFAULT_METRICS_SPARSE_ENCODING
+  #define MEMFAULT_METRICS_SPARSE_ENCODING 0
+#endif
+
+//! Copy a session's metric values into a snapshot while holding memfault_lock() and serialize
+//! the heartbeat or session event from that copy after the lock has been released, instead of
+//! encoding the live values with the lock held. Costs RAM for one copy of every metric value,
+//! string and histogram.
+#ifndef MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+  #define MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT 0
+#endif
+
+//! Number of log2 buckets kept per kMemfaultMetricType_Histogram metric. Each bucket costs 2
+//! bytes of RAM. With the default of 16 buckets, values of 16384 and above share the last bucket.
+#ifndef MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS
+  #define MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS 16
+#endif
+
+//! Tick rate of memfault_platform_metrics_high_res_timer_read(). It is sent with every
+//! kMemfaultMetricType_HighResTimer value so the ticks can be converted to a duration. The
+//! default matches the weak, microsecond based, implementation of the platform function.
+#ifndef MEMFAULT_METRICS_HIGH_RES_TIMER_TICKS_PER_SEC
+  #define MEMFAULT_METRICS_HIGH_RES_TIMER_TICKS_PER_SEC 1000000
+#endif
+
+//! Width in bits of the counter returned by memfault_platform_metrics_high_res_timer_read(),
+//! i.e. 32 for a 32-bit cycle counter or the Arduino micros() timer
+#ifndef MEMFAULT_METRICS_HIGH_RES_TIMER_COUNTER_BITS
+  #define MEMFAULT_METRICS_HIGH_RES_TIMER_COUNTER_BITS 64
+#endif
+
+//! Number of samples kept per kMemfaultMetricType_TimeSeries metric. Each sample costs 8 bytes of
+//! RAM. Once full, the samples are downsampled to the min and max of every 4, so the buffer never
+//! overflows no matter how many samples are recorded during a heartbeat.
+#ifndef MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES
+  #define MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES 32
+#endif
+
+//! The worst case heartbeat size checked on boot is derived at compile time from the metric
+//! definitions (see MEMFAULT_METRICS_HEARTBEAT_MAX_METRICS_SIZE). Enable this to also run a
+//! size-only encode of every metric and assert the compile-time bound covers it. Debug only, the
+//! encode costs boot time proportional to the number of metrics.
+#ifndef MEMFAULT_METRICS_WORST_CASE_SIZE_CROSS_CHECK
+  #define MEMFAULT_METRICS_WORST_CASE_SIZE_CROSS_CHECK 0
+#endif
+
+//! Number of session instances started with memfault_metrics_session_instance_start() that can
+//! be active at the same time, e.g. one per simultaneous BLE connection. Each instance has its
+//! own copy of the metrics of its session. 0 disables the API.
+#ifndef MEMFAULT_METRICS_SESSION_MAX_INSTANCES
+  #define MEMFAULT_METRICS_SESSION_MAX_INSTANCES 0
+#endif
+
+//! Size in bytes of the arena the session instances are allocated from. An instance takes about 9
+//! bytes per metric of its session on 32-bit targets, plus the storage of its strings,
+//! histograms, time series and 64-bit values. memfault_metrics_session_instance_size() returns the
+//! exact amount.
+#ifndef MEMFAULT_METRICS_SESSION_INSTANCES_ARENA_SIZE
+  #define MEMFAULT_METRICS_SESSION_INSTANCES_ARENA_SIZE 1024
+#endif
+
 //
 // Panics Component Configs
 //
@@ -12,7 +12,11 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
+
 #include "memfault-firmware-sdk/components/include/memfault/config.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/cbor.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/varint.h"
 
 #define MEMFAULT_METRICS_SESSION_TIMER_NAME(key_name) mflt_session_timer_##key_name
 
@@ -125,6 +129,249 @@ typedef struct {
 
 #define MEMFAULT_METRICS_SESSION_KEY(key_name) kMfltMetricsSessionKey_##key_name
 
+//! Generate a sparse enum of the positions of the scalar (non-string) metric values in
+//! g_memfault_heartbeat_values
+#undef MEMFAULT_METRICS_KEY_DEFINE_
+#define MEMFAULT_METRICS_KEY_DEFINE_(key_name) kMfltMetricKeyToValueIndex_##key_name,
+
+#define MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE(key_name, value_type, min_value, max_value) \
+  MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type)
+
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
+
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE_WITH_SESSION(key_name, max_length, session_name)
+
+#define MEMFAULT_METRICS_SESSION_KEY_DEFINE(key_name) \
+  MEMFAULT_METRICS_KEY_DEFINE(MEMFAULT_METRICS_SESSION_TIMER_NAME(key_name), _)
+
+#define MEMFAULT_METRICS_KEY_DEFINE_WITH_SESSION(key_name, value_type, session_name) \
+  MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type)
+
+#define MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE_AND_SESSION(key_name, value_type, min_value, \
+                                                           max_value, session_name)         \
+  MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type)
+
+#define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type) MEMFAULT_METRICS_KEY_DEFINE_(key_name)
+
+typedef enum MfltMetricKeyToValueIndex {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_KEY_DEFINE
+#undef MEMFAULT_METRICS_SESSION_KEY_DEFINE
+#undef MEMFAULT_METRICS_KEY_DEFINE_
+  kMfltMetricKeyToValueIndex_Count
+} eMfltMetricKeyToValueIndex;
+
+//! Generate the same positions again, with the metric type pasted into each name. The metric
+//! fast-path macros index with these names, so using a key with the wrong type fails to compile
+#define MEMFAULT_METRICS_KEY_DEFINE_(key_name, value_type) \
+  kMfltMetricValueIndex_##key_name##_##value_type = kMfltMetricKeyToValueIndex_##key_name,
+
+#define MEMFAULT_METRICS_SESSION_KEY_DEFINE(key_name)                        \
+  MEMFAULT_METRICS_KEY_DEFINE(MEMFAULT_METRICS_SESSION_TIMER_NAME(key_name), \
+                              kMemfaultMetricType_Timer)
+
+#define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type) \
+  MEMFAULT_METRICS_KEY_DEFINE_(key_name, value_type)
+
+typedef enum MfltMetricTypedValueIndex {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_KEY_DEFINE
+#undef MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE_WITH_SESSION
+#undef MEMFAULT_METRICS_SESSION_KEY_DEFINE
+#undef MEMFAULT_METRICS_KEY_DEFINE_WITH_SESSION
+#undef MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE_AND_SESSION
+#undef MEMFAULT_METRICS_KEY_DEFINE_
+  // placeholder to prevent an empty enum
+  kMfltMetricValueIndex_Placeholder_
+} eMfltMetricTypedValueIndex;
+
+#define _MEMFAULT_METRICS_VALUE_INDEX(key_name, value_type) \
+  kMfltMetricValueIndex_##key_name##_##value_type
+
+//! Generate a dense enum of the positions of the 64-bit integer metric values in
+//! g_memfault_heartbeat_values64
+#define MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Unsigned(key_name)
+#define MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Signed(key_name)
+#define MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Timer(key_name)
+#define MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Histogram(key_name)
+#define MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_HighResTimer(key_name)
+#define MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_TimeSeries(key_name)
+#define MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Unsigned64(key_name) \
+  kMfltMetricValue64Index_##key_name,
+#define MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Signed64(key_name) \
+  kMfltMetricValue64Index_##key_name,
+
+#define MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE(key_name, value_type, min_value, max_value) \
+  MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type)
+
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
+
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE_WITH_SESSION(key_name, max_length, session_name)
+
+#define MEMFAULT_METRICS_SESSION_KEY_DEFINE(key_name)
+
+#define MEMFAULT_METRICS_KEY_DEFINE_WITH_SESSION(key_name, value_type, session_name) \
+  MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type)
+
+#define MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE_AND_SESSION(key_name, value_type, min_value, \
+                                                           max_value, session_name)         \
+  MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type)
+
+#define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type) \
+  MEMFAULT_METRICS_VALUE64_HELPER_##value_type(key_name)
+
+typedef enum MfltMetricValue64Index {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_KEY_DEFINE
+#undef MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE_WITH_SESSION
+#undef MEMFAULT_METRICS_SESSION_KEY_DEFINE
+#undef MEMFAULT_METRICS_KEY_DEFINE_WITH_SESSION
+#undef MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE_AND_SESSION
+#undef MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_HighResTimer
+#undef MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_VALUE64_HELPER_kMemfaultMetricType_Signed64
+  kMfltMetricValue64Index_Count
+} eMfltMetricValue64Index;
+
+#define _MEMFAULT_METRICS_VALUE64_INDEX(key_name) kMfltMetricValue64Index_##key_name
+
+//! Worst case size of the encoded value of each metric type, used to bound the size of heartbeat
+//! and session events at compile time (see metrics/serializer.h)
+#define MEMFAULT_METRICS_WORST_CASE_SIZE_kMemfaultMetricType_Unsigned 5
+#define MEMFAULT_METRICS_WORST_CASE_SIZE_kMemfaultMetricType_Signed 5
+#define MEMFAULT_METRICS_WORST_CASE_SIZE_kMemfaultMetricType_Timer 5
+#define MEMFAULT_METRICS_WORST_CASE_SIZE_kMemfaultMetricType_Unsigned64 9
+#define MEMFAULT_METRICS_WORST_CASE_SIZE_kMemfaultMetricType_Signed64 9
+//! [count, min, max, sum, bucket 0, ..., bucket N]
+#define MEMFAULT_METRICS_WORST_CASE_SIZE_kMemfaultMetricType_Histogram           \
+  (MEMFAULT_CBOR_UINT_ENCODED_SIZE(4 + MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS) + \
+   (3 * 5) + 9 + (MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS * 3))
+//! [ticks, ticks per second]
+#define MEMFAULT_METRICS_WORST_CASE_SIZE_kMemfaultMetricType_HighResTimer \
+  (1 + 9 + MEMFAULT_CBOR_UINT_ENCODED_SIZE(MEMFAULT_METRICS_HIGH_RES_TIMER_TICKS_PER_SEC))
+//! Every sample slot plus the min and max of the partial bucket
+#define MEMFAULT_METRICS_TIME_SERIES_MAX_PAIR_LEN (2 * MEMFAULT_UINT32_MAX_VARINT_LENGTH)
+#define MEMFAULT_METRICS_TIME_SERIES_MAX_ENCODED_LEN \
+  ((MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES + 2) * MEMFAULT_METRICS_TIME_SERIES_MAX_PAIR_LEN)
+#define MEMFAULT_METRICS_WORST_CASE_SIZE_kMemfaultMetricType_TimeSeries            \
+  (MEMFAULT_CBOR_UINT_ENCODED_SIZE(MEMFAULT_METRICS_TIME_SERIES_MAX_ENCODED_LEN) + \
+   MEMFAULT_METRICS_TIME_SERIES_MAX_ENCODED_LEN)
+#define MEMFAULT_METRICS_WORST_CASE_SIZE_STRING(max_length) \
+  (MEMFAULT_CBOR_UINT_ENCODED_SIZE(max_length) + (max_length))
+
+//! Sum up the worst case size of the metrics in the configuration with a term per metric,
+//! MEMFAULT_METRICS_WORST_CASE_TERM_(session_key, value_size), defined before each expansion
+#define MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE_AND_SESSION(key_name, value_type, min_value, \
+                                                           max_value, session_name)         \
+  MEMFAULT_METRICS_WORST_CASE_TERM_(kMfltMetricsSessionKey_##session_name,                  \
+                                    MEMFAULT_METRICS_WORST_CASE_SIZE_##value_type)
+#define MEMFAULT_METRICS_KEY_DEFINE_WITH_SESSION(key_name, value_type, session_name) \
+  MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE_AND_SESSION(key_name, value_type, 0, 0, session_name)
+#define MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE(key_name, value_type, min_value, max_value) \
+  MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE_AND_SESSION(key_name, value_type, 0, 0, heartbeat)
+#define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type) \
+  MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE_AND_SESSION(key_name, value_type, 0, 0, heartbeat)
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE_WITH_SESSION(key_name, max_length, session_name) \
+  MEMFAULT_METRICS_WORST_CASE_TERM_(kMfltMetricsSessionKey_##session_name,                  \
+                                    MEMFAULT_METRICS_WORST_CASE_SIZE_STRING(max_length))
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length) \
+  MEMFAULT_METRICS_STRING_KEY_DEFINE_WITH_SESSION(key_name, max_length, heartbeat)
+#define MEMFAULT_METRICS_SESSION_KEY_DEFINE(key_name) \
+  MEMFAULT_METRICS_KEY_DEFINE_WITH_SESSION(_, kMemfaultMetricType_Timer, key_name)
+
+typedef enum MfltMetricsWorstCase {
+#define MEMFAULT_METRICS_WORST_CASE_TERM_(session_key, value_size) +1
+  kMfltMetricsWorstCaseNumMetrics = 0
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+  ,
+#undef MEMFAULT_METRICS_WORST_CASE_TERM_
+#define MEMFAULT_METRICS_WORST_CASE_TERM_(session_key, value_size) \
+  +((session_key) == kMfltMetricsSessionKey_heartbeat)
+  kMfltMetricsWorstCaseNumHeartbeatMetrics = 0
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+  ,
+#undef MEMFAULT_METRICS_WORST_CASE_TERM_
+#if MEMFAULT_METRICS_SPARSE_ENCODING
+  // each metric is keyed by its position in the session
+  #define MEMFAULT_METRICS_WORST_CASE_KEY_SIZE_ \
+    MEMFAULT_CBOR_UINT_ENCODED_SIZE(kMfltMetricsWorstCaseNumMetrics)
+#else
+  #define MEMFAULT_METRICS_WORST_CASE_KEY_SIZE_ 0
+#endif
+#define MEMFAULT_METRICS_WORST_CASE_TERM_(session_key, value_size) \
+  +(((session_key) == kMfltMetricsSessionKey_heartbeat) ?          \
+      (MEMFAULT_METRICS_WORST_CASE_KEY_SIZE_ + (value_size)) :     \
+      0)
+  kMfltMetricsWorstCaseHeartbeatValuesSize = 0
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+  ,
+#undef MEMFAULT_METRICS_WORST_CASE_TERM_
+// no session can be larger than all of the metrics outside of the heartbeat put together
+#define MEMFAULT_METRICS_WORST_CASE_TERM_(session_key, value_size) \
+  +(((session_key) != kMfltMetricsSessionKey_heartbeat) ?          \
+      (MEMFAULT_METRICS_WORST_CASE_KEY_SIZE_ + (value_size)) :     \
+      0)
+  kMfltMetricsWorstCaseSessionValuesSize = 0
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_WORST_CASE_TERM_
+#undef MEMFAULT_METRICS_WORST_CASE_KEY_SIZE_
+} eMfltMetricsWorstCase;
+#undef MEMFAULT_METRICS_KEY_DEFINE
+#undef MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE_WITH_SESSION
+#undef MEMFAULT_METRICS_SESSION_KEY_DEFINE
+#undef MEMFAULT_METRICS_KEY_DEFINE_WITH_SESSION
+#undef MEMFAULT_METRICS_KEY_DEFINE_WITH_RANGE_AND_SESSION
+
+union MemfaultMetricValue {
+  uint32_t u32;
+  int32_t i32;
+  void *ptr;
+};
+
+// Value Set flag data structures and definitions
+// MEMFAULT_IS_SET_FLAGS_PER_BYTE must be a power of 2
+// MEMFAULT_IS_SET_FLAGS_DIVIDER must be equal to log2(MEMFAULT_IS_SET_FLAGS_PER_BYTE)
+#define MEMFAULT_IS_SET_FLAGS_PER_BYTE 8
+#define MEMFAULT_IS_SET_FLAGS_DIVIDER 3
+
+//! Storage for the scalar metric values, indexed by eMfltMetricKeyToValueIndex, and a bit per
+//! value tracking whether it was set during the current heartbeat or session. These are only
+//! exposed so the metric fast-path macros can resolve a key to its storage at compile time and
+//! should never be accessed directly.
+extern union MemfaultMetricValue g_memfault_heartbeat_values[];
+extern uint8_t g_memfault_heartbeat_value_is_set_flags[];
+
+//! Value of a kMemfaultMetricType_Unsigned64 or kMemfaultMetricType_Signed64 metric. Held as two
+//! 32-bit words (two's complement for signed values) so 32-bit targets can update the low word
+//! alone unless the add carries into the high word.
+typedef struct MemfaultMetricValue64 {
+  uint32_t lo;
+  uint32_t hi;
+} sMemfaultMetricValue64;
+
+//! Storage for the 64-bit integer metric values, indexed by eMfltMetricValue64Index. Their is-set
+//! bits are the ones in g_memfault_heartbeat_value_is_set_flags. Only exposed for the metric
+//! fast-path macros, like the arrays above.
+extern sMemfaultMetricValue64 g_memfault_heartbeat_values64[];
+
 #define _MEMFAULT_METRICS_ID_CREATE(id) \
   { kMfltMetricsIndex_##id }
 
@@ -31,6 +31,7 @@
 
 #include "memfault-firmware-sdk/components/include/memfault/config.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/event_storage.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/platform/overrides.h"
 #include "memfault-firmware-sdk/components/include/memfault/metrics/ids_impl.h"
 
 #ifdef __cplusplus
@@ -49,6 +50,30 @@ typedef enum MemfaultMetricValueType {
   kMemfaultMetricType_Timer,
   //! Set a string value for a metric
   kMemfaultMetricType_String,
+  //! Tracks the distribution of recorded values (i.e request latency). Keeps count, min, max,
+  //! sum and a log2-bucketed histogram in fixed memory. See memfault_metrics_heartbeat_record()
+  //! @note Serialized as a CBOR array, which the Memfault cloud needs to support decoding. Older
+  //! ingestion does not understand it, so only define histogram metrics once it does.
+  kMemfaultMetricType_Histogram,
+  //! Same as kMemfaultMetricType_Timer, but measured with the high resolution counter from
+  //! memfault_platform_metrics_high_res_timer_read() and accumulated in 64 bits, for short and
+  //! frequent intervals such as ISR or radio on time
+  //! @note Serialized as a [ticks, ticks per second] CBOR array, which the Memfault cloud needs to
+  //! support decoding before these metrics are defined
+  kMemfaultMetricType_HighResTimer,
+  //! unsigned integer (64-bits), for counters which can exceed 32 bits within a heartbeat such as
+  //! bytes transferred
+  //! @note Values above 32 bits are serialized as 8-byte CBOR integers, which the Memfault cloud
+  //! needs to support decoding before these metrics are defined
+  kMemfaultMetricType_Unsigned64,
+  //! signed integer (64-bits)
+  //! @note Same cloud requirement as kMemfaultMetricType_Unsigned64
+  kMemfaultMetricType_Signed64,
+  //! Time-stamped samples of a signed value (i.e battery SoC, RSSI or heap usage) over the
+  //! heartbeat, kept in fixed memory by downsampling. See memfault_metrics_heartbeat_sample()
+  //! @note Serialized as a CBOR byte string of varint encoded (time, value) deltas, which the
+  //! Memfault cloud needs to support decoding before these metrics are defined
+  kMemfaultMetricType_TimeSeries,
 
   //! Number of valid types. Must _always_ be last
   kMemfaultMetricType_NumTypes,
@@ -136,6 +161,56 @@ typedef struct MemfaultMetricsBootInfo {
   uint32_t unexpected_reboot_count;
 } sMemfaultMetricBootInfo;
 
+//! State tracked for a kMemfaultMetricType_Histogram metric over a heartbeat or session.
+//!
+//! Bucket 0 counts values of 0 and bucket n counts values in [2^(n-1), 2^n). The last bucket
+//! also counts every value that does not fit in the ones before it. When a bucket count would
+//! overflow, every bucket is halved, so bucket counts are relative once 'count' exceeds
+//! UINT16_MAX.
+typedef struct MemfaultMetricHistogram {
+  uint32_t count;
+  uint32_t min;
+  uint32_t max;
+  uint64_t sum;
+  uint16_t buckets[MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS];
+} sMemfaultMetricHistogram;
+
+//! State tracked for a kMemfaultMetricType_HighResTimer metric. Counts are in ticks of the
+//! counter returned by memfault_platform_metrics_high_res_timer_read().
+typedef struct MemfaultMetricHighResTimer {
+  //! Ticks accumulated while the timer was running during the heartbeat or session
+  uint64_t total_ticks;
+  //! Counter value when the timer was started, or last updated while running
+  uint64_t start_ticks;
+  bool is_running;
+} sMemfaultMetricHighResTimer;
+
+//! One sample of a kMemfaultMetricType_TimeSeries metric
+typedef struct MemfaultMetricTimeSeriesSample {
+  //! Milliseconds since the start of the heartbeat or session
+  uint32_t offset_ms;
+  int32_t value;
+} sMemfaultMetricTimeSeriesSample;
+
+//! State tracked for a kMemfaultMetricType_TimeSeries metric over a heartbeat or session.
+//!
+//! Recorded samples are gathered in buckets, and the min and max sample of each bucket are
+//! appended to 'samples', in time order. Buckets start out holding a single sample. When
+//! 'samples' is full, every group of 4 is replaced by its min and max and the bucket size doubles,
+//! so spikes are kept while the time resolution halves.
+typedef struct MemfaultMetricTimeSeries {
+  //! Uptime the heartbeat or session started at, which sample offsets are relative to
+  uint64_t start_ms;
+  uint16_t num_samples;
+  //! Number of times 'samples' was downsampled
+  uint8_t level;
+  //! Number of samples recorded into the current, partial, bucket and its min and max
+  uint32_t bucket_count;
+  sMemfaultMetricTimeSeriesSample bucket_min;
+  sMemfaultMetricTimeSeriesSample bucket_max;
+  sMemfaultMetricTimeSeriesSample samples[MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES];
+} sMemfaultMetricTimeSeries;
+
 //! Initializes the metric events API.
 //! All heartbeat values will be initialized to their reset values.
 //! Integer types will be reset to unset/null.
@@ -162,6 +237,13 @@ int memfault_metrics_heartbeat_set_signed(MemfaultMetricId key, int32_t signed_v
 //! Same as @memfault_metrics_heartbeat_set_signed except for a unsigned integer metric
 int memfault_metrics_heartbeat_set_unsigned(MemfaultMetricId key, uint32_t unsigned_value);
 
+//! Same as @memfault_metrics_heartbeat_set_signed except for a kMemfaultMetricType_Signed64 metric
+int memfault_metrics_heartbeat_set_signed64(MemfaultMetricId key, int64_t signed_value);
+
+//! Same as @memfault_metrics_heartbeat_set_signed except for a kMemfaultMetricType_Unsigned64
+//! metric
+int memfault_metrics_heartbeat_set_unsigned64(MemfaultMetricId key, uint64_t unsigned_value);
+
 //! Set the value of a string metric.
 //! @param key The key of the metric. @see MEMFAULT_METRICS_KEY
 //! @param value The new value to set for the metric
@@ -189,14 +271,53 @@ int memfault_metrics_heartbeat_timer_stop(MemfaultMetricId key);
 //! @param key The key of the metric. @see MEMFAULT_METRICS_KEY
 //! @param inc The amount to increment the metric by
 //! @return 0 on success, else error code
-//! @note The metric must be of type kMemfaultMetricType_Unsigned or kMemfaultMetricType_Signed
+//! @note The metric must be of type kMemfaultMetricType_Unsigned, kMemfaultMetricType_Signed,
+//! kMemfaultMetricType_Unsigned64 or kMemfaultMetricType_Signed64. The result is clipped at the
+//! limits of the metric type.
 int memfault_metrics_heartbeat_add(MemfaultMetricId key, int32_t amount);
 
+//! Record a sample in a histogram metric.
+//!
+//! The cost of a record is constant: the sample updates count, min, max and sum and increments
+//! the log2 bucket it falls in. Histograms with no samples recorded during a heartbeat interval
+//! are sent as null.
+//! @param key The key of the metric. @see MEMFAULT_METRICS_KEY
+//! @param value The sample to record
+//! @return 0 on success, else error code
+//! @note The metric must be of type kMemfaultMetricType_Histogram
+int memfault_metrics_heartbeat_record(MemfaultMetricId key, uint32_t value);
+
+//! Record a time-stamped sample in a time series metric.
+//!
+//! The sample is timestamped with memfault_platform_get_time_since_boot_ms(). Memory use is
+//! fixed: once MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES are held, the series is downsampled,
+//! keeping the min and max of each span of time. Time series with no samples recorded during a
+//! heartbeat interval are sent as null.
+//! @param key The key of the metric. @see MEMFAULT_METRICS_KEY
+//! @param value The sample to record
+//! @return 0 on success, else error code
+//! @note The metric must be of type kMemfaultMetricType_TimeSeries
+int memfault_metrics_heartbeat_sample(MemfaultMetricId key, int32_t value);
+
+//! Estimate a percentile from a histogram.
+//!
+//! The estimate is the upper bound of the bucket holding the requested percentile, clamped to
+//! the recorded min and max.
+//! @param histogram The histogram to compute the percentile for
+//! @param percentile The percentile to compute, in the range 0-100
+//! @return The estimated value, or 0 if the histogram has no samples
+uint32_t memfault_metrics_histogram_percentile(const sMemfaultMetricHistogram *histogram,
+                                               uint32_t percentile);
+
 //! Alternate API that includes the 'MEMFAULT_METRICS_KEY()' expansion
 #define MEMFAULT_METRIC_SET_SIGNED(key_name, signed_value) \
   memfault_metrics_heartbeat_set_signed(MEMFAULT_METRICS_KEY(key_name), (signed_value))
 #define MEMFAULT_METRIC_SET_UNSIGNED(key_name, unsigned_value) \
   memfault_metrics_heartbeat_set_unsigned(MEMFAULT_METRICS_KEY(key_name), (unsigned_value))
+#define MEMFAULT_METRIC_SET_SIGNED64(key_name, signed_value) \
+  memfault_metrics_heartbeat_set_signed64(MEMFAULT_METRICS_KEY(key_name), (signed_value))
+#define MEMFAULT_METRIC_SET_UNSIGNED64(key_name, unsigned_value) \
+  memfault_metrics_heartbeat_set_unsigned64(MEMFAULT_METRICS_KEY(key_name), (unsigned_value))
 #define MEMFAULT_METRIC_SET_STRING(key_name, value) \
   memfault_metrics_heartbeat_set_string(MEMFAULT_METRICS_KEY(key_name), (value))
 #define MEMFAULT_METRIC_TIMER_START(key_name) \
@@ -205,6 +326,106 @@ int memfault_metrics_heartbeat_add(MemfaultMetricId key, int32_t amount);
   memfault_metrics_heartbeat_timer_stop(MEMFAULT_METRICS_KEY(key_name))
 #define MEMFAULT_METRIC_ADD(key_name, amount) \
   memfault_metrics_heartbeat_add(MEMFAULT_METRICS_KEY(key_name), (amount))
+#define MEMFAULT_METRIC_RECORD(key_name, value) \
+  memfault_metrics_heartbeat_record(MEMFAULT_METRICS_KEY(key_name), (value))
+#define MEMFAULT_METRIC_SAMPLE(key_name, value) \
+  memfault_metrics_heartbeat_sample(MEMFAULT_METRICS_KEY(key_name), (value))
+
+//! Fast-path variants of the integer metric setters, for use in hot code paths.
+//!
+//! The APIs above look the key up at runtime (bounds check, value index table, type check).
+//! These macros resolve the key to its storage and is-set bit at compile time instead, so an
+//! update is a lock, a few loads/stores and an unlock. Using a key that is not defined with the
+//! matching type fails to compile with an undeclared 'kMfltMetricValueIndex_<key>_<type>'.
+//!
+//! @note Unlike MEMFAULT_METRIC_ADD, MEMFAULT_METRIC_FAST_ADD_UNSIGNED takes an unsigned amount.
+//! Both add variants clip at the limits of the metric type instead of wrapping.
+#define MEMFAULT_METRIC_FAST_SET_UNSIGNED(key_name, unsigned_value)     \
+  MEMFAULT_METRICS_FAST_UPDATE_(key_name, kMemfaultMetricType_Unsigned, \
+                                _valp->u32 = (uint32_t)(unsigned_value))
+#define MEMFAULT_METRIC_FAST_SET_SIGNED(key_name, signed_value)       \
+  MEMFAULT_METRICS_FAST_UPDATE_(key_name, kMemfaultMetricType_Signed, \
+                                _valp->i32 = (int32_t)(signed_value))
+#define MEMFAULT_METRIC_FAST_ADD_UNSIGNED(key_name, amount)               \
+  MEMFAULT_METRICS_FAST_UPDATE_(key_name, kMemfaultMetricType_Unsigned, { \
+    const uint32_t _new_value = _valp->u32 + (uint32_t)(amount);          \
+    _valp->u32 = (_new_value < _valp->u32) ? UINT32_MAX : _new_value;     \
+  })
+#define MEMFAULT_METRIC_FAST_ADD_SIGNED(key_name, amount)               \
+  MEMFAULT_METRICS_FAST_UPDATE_(key_name, kMemfaultMetricType_Signed, { \
+    const int64_t _new_value = (int64_t)_valp->i32 + (int32_t)(amount); \
+    _valp->i32 = (_new_value > INT32_MAX) ? INT32_MAX :                 \
+                 (_new_value < INT32_MIN) ? INT32_MIN :                 \
+                                            (int32_t)_new_value;        \
+  })
+
+//! Fast-path variants for the 64-bit integer metrics. The value is updated as two 32-bit words:
+//! an add only touches the high word when the low word carries, so the common case stays a
+//! single 32-bit add and compare on 32-bit targets. The amount is 32 bits, like
+//! MEMFAULT_METRIC_FAST_ADD_UNSIGNED and MEMFAULT_METRIC_FAST_ADD_SIGNED.
+#define MEMFAULT_METRIC_FAST_SET_UNSIGNED64(key_name, unsigned_value)         \
+  MEMFAULT_METRICS_FAST_UPDATE64_(key_name, kMemfaultMetricType_Unsigned64, { \
+    const uint64_t _value = (uint64_t)(unsigned_value);                       \
+    _valp->lo = (uint32_t)_value;                                             \
+    _valp->hi = (uint32_t)(_value >> 32);                                     \
+  })
+#define MEMFAULT_METRIC_FAST_SET_SIGNED64(key_name, signed_value)           \
+  MEMFAULT_METRICS_FAST_UPDATE64_(key_name, kMemfaultMetricType_Signed64, { \
+    const uint64_t _value = (uint64_t)(int64_t)(signed_value);              \
+    _valp->lo = (uint32_t)_value;                                           \
+    _valp->hi = (uint32_t)(_value >> 32);                                   \
+  })
+#define MEMFAULT_METRIC_FAST_ADD_UNSIGNED64(key_name, amount)                 \
+  MEMFAULT_METRICS_FAST_UPDATE64_(key_name, kMemfaultMetricType_Unsigned64, { \
+    const uint32_t _amount = (uint32_t)(amount);                              \
+    uint32_t _lo = _valp->lo + _amount;                                       \
+    if (_lo < _amount) {                                                      \
+      if (_valp->hi != UINT32_MAX) {                                          \
+        _valp->hi++;                                                          \
+      } else {                                                                \
+        _lo = UINT32_MAX;                                                     \
+      }                                                                       \
+    }                                                                         \
+    _valp->lo = _lo;                                                          \
+  })
+#define MEMFAULT_METRIC_FAST_ADD_SIGNED64(key_name, amount)                             \
+  MEMFAULT_METRICS_FAST_UPDATE64_(key_name, kMemfaultMetricType_Signed64, {             \
+    const int32_t _amount = (int32_t)(amount);                                          \
+    const uint32_t _amount_hi = (_amount < 0) ? UINT32_MAX : 0; /* sign extension */    \
+    const uint32_t _lo = _valp->lo + (uint32_t)_amount;                                 \
+    const uint32_t _hi = _valp->hi + _amount_hi + (uint32_t)(_lo < (uint32_t)_amount);  \
+    /* overflow if both operands have the same sign and the result has the other one */ \
+    if ((~(_valp->hi ^ _amount_hi) & (_valp->hi ^ _hi)) & 0x80000000u) {                \
+      _valp->lo = (_amount < 0) ? 0 : UINT32_MAX;                                       \
+      _valp->hi = (_amount < 0) ? 0x80000000u : 0x7FFFFFFFu;                            \
+    } else {                                                                            \
+      _valp->lo = _lo;                                                                  \
+      _valp->hi = _hi;                                                                  \
+    }                                                                                   \
+  })
+
+#define MEMFAULT_METRICS_FAST_UPDATE_(key_name, value_type, ...)                      \
+  do {                                                                                \
+    const size_t _idx = _MEMFAULT_METRICS_VALUE_INDEX(key_name, value_type);          \
+    union MemfaultMetricValue *const _valp = &g_memfault_heartbeat_values[_idx];      \
+    memfault_lock();                                                                  \
+    __VA_ARGS__;                                                                      \
+    g_memfault_heartbeat_value_is_set_flags[_idx >> MEMFAULT_IS_SET_FLAGS_DIVIDER] |= \
+      (uint8_t)(1u << (_idx % MEMFAULT_IS_SET_FLAGS_PER_BYTE));                       \
+    memfault_unlock();                                                                \
+  } while (0)
+
+#define MEMFAULT_METRICS_FAST_UPDATE64_(key_name, value_type, ...)                    \
+  do {                                                                                \
+    const size_t _idx = _MEMFAULT_METRICS_VALUE_INDEX(key_name, value_type);          \
+    sMemfaultMetricValue64 *const _valp =                                             \
+      &g_memfault_heartbeat_values64[_MEMFAULT_METRICS_VALUE64_INDEX(key_name)];      \
+    memfault_lock();                                                                  \
+    __VA_ARGS__;                                                                      \
+    g_memfault_heartbeat_value_is_set_flags[_idx >> MEMFAULT_IS_SET_FLAGS_DIVIDER] |= \
+      (uint8_t)(1u << (_idx % MEMFAULT_IS_SET_FLAGS_PER_BYTE));                       \
+    memfault_unlock();                                                                \
+  } while (0)
 
 //! For debugging purposes: prints the current heartbeat values using
 //! MEMFAULT_LOG_DEBUG(). Before printing, any active timer values are computed.
@@ -237,9 +458,16 @@ void memfault_metrics_heartbeat_debug_trigger(void);
 //! For debugging and unit test purposes, allows for the extraction of different values
 int memfault_metrics_heartbeat_read_unsigned(MemfaultMetricId key, uint32_t *read_val);
 int memfault_metrics_heartbeat_read_signed(MemfaultMetricId key, int32_t *read_val);
+int memfault_metrics_heartbeat_read_unsigned64(MemfaultMetricId key, uint64_t *read_val);
+int memfault_metrics_heartbeat_read_signed64(MemfaultMetricId key, int64_t *read_val);
 int memfault_metrics_heartbeat_timer_read(MemfaultMetricId key, uint32_t *read_val);
+int memfault_metrics_heartbeat_high_res_timer_read(MemfaultMetricId key, uint64_t *read_ticks);
 int memfault_metrics_heartbeat_read_string(MemfaultMetricId key, char *read_val,
                                            size_t read_val_len);
+int memfault_metrics_heartbeat_read_histogram(MemfaultMetricId key,
+                                              sMemfaultMetricHistogram *read_val);
+int memfault_metrics_heartbeat_read_time_series(MemfaultMetricId key,
+                                                sMemfaultMetricTimeSeries *read_val);
 
 //! Callback used to collect custom metrics at the start of a session.
 //!
@@ -279,6 +507,10 @@ int memfault_metrics_session_start(eMfltMetricsSessionIndex session_key);
 //! Used to stop a metric "session".
 //!
 //! Same as @memfault_metrics_session_start except for stopping a session.
+//!
+//! @note With MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT, a session that ends while another event
+//! is being serialized from the snapshot is serialized right after it, by that caller. If the
+//! session is started again before then, its previous values are dropped.
 int memfault_metrics_session_end(eMfltMetricsSessionIndex session_key);
 
 //! Alternate API that includes the 'MEMFAULT_METRICS_SESSION_KEY()' expansion
@@ -287,6 +519,98 @@ int memfault_metrics_session_end(eMfltMetricsSessionIndex session_key);
 #define MEMFAULT_METRICS_SESSION_END(key) \
   memfault_metrics_session_end(MEMFAULT_METRICS_SESSION_KEY(key))
 
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+
+//! Handle to one active instance of a session, see memfault_metrics_session_instance_start()
+typedef struct {
+  uint16_t _impl;
+} MemfaultMetricsSessionHandle;
+
+//! Start a new instance of a session.
+//!
+//! Unlike memfault_metrics_session_start(), which restarts the one set of values of a session,
+//! every instance gets its own copy of the session's metrics and session timer, so instances of
+//! the same session can overlap, e.g. one per simultaneous BLE connection. Instances are taken
+//! from a pool of MEMFAULT_METRICS_SESSION_MAX_INSTANCES sharing an arena of
+//! MEMFAULT_METRICS_SESSION_INSTANCES_ARENA_SIZE bytes. The start and end callbacks registered
+//! for the session are not called for instances.
+//!
+//! @note Instances rely on memfault_lock() to keep the metrics of an instance and the heartbeat
+//! apart, it must be implemented if metrics are recorded from more than one task.
+//!
+//! @param session_key The session to start an instance of, anything but the heartbeat
+//! @param handle Set to the handle of the new instance on success
+//! @return 0 on success, else error code, e.g. if the pool or the arena is exhausted
+int memfault_metrics_session_instance_start(eMfltMetricsSessionIndex session_key,
+                                            MemfaultMetricsSessionHandle *handle);
+
+//! End a session instance: serialize its metrics into a session event and release it. The handle
+//! is invalid afterwards, even if the event did not fit in storage.
+int memfault_metrics_session_instance_end(MemfaultMetricsSessionHandle handle);
+
+//! Number of bytes of the arena taken by each instance of 'session_key'
+size_t memfault_metrics_session_instance_size(eMfltMetricsSessionIndex session_key);
+
+//! Same as the memfault_metrics_heartbeat_*() APIs, for the metrics of one session instance.
+//! 'key' must be a metric of the instance's session.
+int memfault_metrics_session_instance_set_signed(MemfaultMetricsSessionHandle handle,
+                                                 MemfaultMetricId key, int32_t signed_value);
+int memfault_metrics_session_instance_set_unsigned(MemfaultMetricsSessionHandle handle,
+                                                   MemfaultMetricId key, uint32_t unsigned_value);
+int memfault_metrics_session_instance_set_signed64(MemfaultMetricsSessionHandle handle,
+                                                   MemfaultMetricId key, int64_t signed_value);
+int memfault_metrics_session_instance_set_unsigned64(MemfaultMetricsSessionHandle handle,
+                                                     MemfaultMetricId key,
+                                                     uint64_t unsigned_value);
+int memfault_metrics_session_instance_set_string(MemfaultMetricsSessionHandle handle,
+                                                 MemfaultMetricId key, const char *value);
+int memfault_metrics_session_instance_timer_start(MemfaultMetricsSessionHandle handle,
+                                                  MemfaultMetricId key);
+int memfault_metrics_session_instance_timer_stop(MemfaultMetricsSessionHandle handle,
+                                                 MemfaultMetricId key);
+int memfault_metrics_session_instance_add(MemfaultMetricsSessionHandle handle,
+                                          MemfaultMetricId key, int32_t amount);
+int memfault_metrics_session_instance_record(MemfaultMetricsSessionHandle handle,
+                                             MemfaultMetricId key, uint32_t value);
+int memfault_metrics_session_instance_sample(MemfaultMetricsSessionHandle handle,
+                                             MemfaultMetricId key, int32_t value);
+
+//! For debugging and unit test purposes, allows for the extraction of different values
+int memfault_metrics_session_instance_read_unsigned(MemfaultMetricsSessionHandle handle,
+                                                    MemfaultMetricId key, uint32_t *read_val);
+int memfault_metrics_session_instance_read_signed(MemfaultMetricsSessionHandle handle,
+                                                  MemfaultMetricId key, int32_t *read_val);
+int memfault_metrics_session_instance_timer_read(MemfaultMetricsSessionHandle handle,
+                                                 MemfaultMetricId key, uint32_t *read_val);
+int memfault_metrics_session_instance_read_histogram(MemfaultMetricsSessionHandle handle,
+                                                     MemfaultMetricId key,
+                                                     sMemfaultMetricHistogram *read_val);
+
+//! Alternate API that includes the 'MEMFAULT_METRICS_SESSION_KEY()' and 'MEMFAULT_METRICS_KEY()'
+//! expansions
+#define MEMFAULT_METRICS_SESSION_INSTANCE_START(key, handle) \
+  memfault_metrics_session_instance_start(MEMFAULT_METRICS_SESSION_KEY(key), (handle))
+#define MEMFAULT_METRIC_INSTANCE_SET_SIGNED(handle, key_name, signed_value)              \
+  memfault_metrics_session_instance_set_signed((handle), MEMFAULT_METRICS_KEY(key_name), \
+                                               (signed_value))
+#define MEMFAULT_METRIC_INSTANCE_SET_UNSIGNED(handle, key_name, unsigned_value)            \
+  memfault_metrics_session_instance_set_unsigned((handle), MEMFAULT_METRICS_KEY(key_name), \
+                                                 (unsigned_value))
+#define MEMFAULT_METRIC_INSTANCE_SET_STRING(handle, key_name, value) \
+  memfault_metrics_session_instance_set_string((handle), MEMFAULT_METRICS_KEY(key_name), (value))
+#define MEMFAULT_METRIC_INSTANCE_TIMER_START(handle, key_name) \
+  memfault_metrics_session_instance_timer_start((handle), MEMFAULT_METRICS_KEY(key_name))
+#define MEMFAULT_METRIC_INSTANCE_TIMER_STOP(handle, key_name) \
+  memfault_metrics_session_instance_timer_stop((handle), MEMFAULT_METRICS_KEY(key_name))
+#define MEMFAULT_METRIC_INSTANCE_ADD(handle, key_name, amount) \
+  memfault_metrics_session_instance_add((handle), MEMFAULT_METRICS_KEY(key_name), (amount))
+#define MEMFAULT_METRIC_INSTANCE_RECORD(handle, key_name, value) \
+  memfault_metrics_session_instance_record((handle), MEMFAULT_METRICS_KEY(key_name), (value))
+#define MEMFAULT_METRIC_INSTANCE_SAMPLE(handle, key_name, value) \
+  memfault_metrics_session_instance_sample((handle), MEMFAULT_METRICS_KEY(key_name), (value))
+
+#endif  // MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+
 //! Collect built-in metrics as part of default ports in memfault-firmware-sdk.
 //!
 //! It can (optionally) be overridden by a port to collect a set of built-in metrics
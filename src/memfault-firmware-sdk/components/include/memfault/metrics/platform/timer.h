@@ -27,6 +27,19 @@ typedef void(MemfaultPlatformTimerCallback)(void);
 bool memfault_platform_metrics_timer_boot(uint32_t period_sec,
                                           MemfaultPlatformTimerCallback *callback);
 
+//! Read the free-running counter kMemfaultMetricType_HighResTimer metrics are measured with, for
+//! example a microsecond timer or a CPU cycle counter (DWT->CYCCNT on Cortex-M).
+//!
+//! The counter must tick at MEMFAULT_METRICS_HIGH_RES_TIMER_TICKS_PER_SEC. Only the low
+//! MEMFAULT_METRICS_HIGH_RES_TIMER_COUNTER_BITS bits are used, and the counter may wrap as long
+//! as it does not wrap twice between a timer start and the next stop or heartbeat.
+//!
+//! @note A weak implementation derived from memfault_platform_get_time_since_boot_ms() is
+//! provided, so high resolution timers only have millisecond resolution until this is overridden
+//!
+//! @return the current counter value
+uint64_t memfault_platform_metrics_high_res_timer_read(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -15,20 +15,56 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "memfault-firmware-sdk/components/include/memfault/core/compiler.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/event_storage.h"
 #include "memfault-firmware-sdk/components/include/memfault/metrics/ids_impl.h"
+#include "memfault-firmware-sdk/components/include/memfault/metrics/metrics.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/cbor.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+//! Event info key, its dictionary of 2, the session index and the header of the metrics
+#define MEMFAULT_METRICS_WORST_CASE_EVENT_INFO_HEADER_SIZE(num_metrics)                       \
+  (1 + 1 + 1 + MEMFAULT_CBOR_UINT_ENCODED_SIZE(MEMFAULT_METRICS_SESSION_KEY(heartbeat)) + 1 + \
+   MEMFAULT_CBOR_UINT_ENCODED_SIZE(num_metrics))
+
+//! Compile-time upper bound on the size of the metrics of a heartbeat event, derived from the
+//! metric definitions. The complete event adds the metadata common to all events (see
+//! memfault_metrics_heartbeat_compute_worst_case_storage_size()).
+#define MEMFAULT_METRICS_HEARTBEAT_MAX_METRICS_SIZE                                               \
+  (MEMFAULT_METRICS_WORST_CASE_EVENT_INFO_HEADER_SIZE(kMfltMetricsWorstCaseNumHeartbeatMetrics) + \
+   kMfltMetricsWorstCaseHeartbeatValuesSize)
+
+//! Same as MEMFAULT_METRICS_HEARTBEAT_MAX_METRICS_SIZE, for the largest session event
+#define MEMFAULT_METRICS_SESSION_MAX_METRICS_SIZE                                        \
+  (MEMFAULT_METRICS_WORST_CASE_EVENT_INFO_HEADER_SIZE(kMfltMetricsWorstCaseNumMetrics) + \
+   kMfltMetricsWorstCaseSessionValuesSize)
+
+//! Fail the build if an event storage buffer of 'storage_size' bytes can't hold the metrics of a
+//! heartbeat, for example:
+//!
+//!   static uint8_t s_event_storage[1024];
+//!   MEMFAULT_METRICS_HEARTBEAT_STORAGE_STATIC_ASSERT(sizeof(s_event_storage));
+//!
+//! @note The metadata of the event (device info, build id, ...) is not included, keep some
+//! headroom on top of MEMFAULT_METRICS_HEARTBEAT_MAX_METRICS_SIZE
+#define MEMFAULT_METRICS_HEARTBEAT_STORAGE_STATIC_ASSERT(storage_size)                  \
+  MEMFAULT_STATIC_ASSERT((storage_size) >= MEMFAULT_METRICS_HEARTBEAT_MAX_METRICS_SIZE, \
+                         "Event storage smaller than the metrics of a heartbeat")
+
 //! Compute the worst case number of bytes required to serialize Memfault metrics for a heartbeat.
 //!
+//! The metrics are bounded at compile time by MEMFAULT_METRICS_HEARTBEAT_MAX_METRICS_SIZE, only
+//! the event metadata is encoded at runtime.
+//!
 //! @return the worst case amount of space needed to serialize an event
 size_t memfault_metrics_heartbeat_compute_worst_case_storage_size(void);
 
 //! Compute the worst case number of bytes required to serialize Memfault metrics for a given
-//! session
+//! session. Performs a size-only encode of the session's metrics, see
+//! MEMFAULT_METRICS_SESSION_MAX_METRICS_SIZE for a compile-time bound.
 size_t memfault_metrics_session_compute_worst_case_storage_size(eMfltMetricsSessionIndex session);
 
 //! Serialize out the current set of heartbeat metrics
@@ -40,6 +76,19 @@ bool memfault_metrics_heartbeat_serialize(const sMemfaultEventStorageImpl *stora
 bool memfault_metrics_session_serialize(const sMemfaultEventStorageImpl *storage_impl,
                                         eMfltMetricsSessionIndex session);
 
+//! Same as memfault_metrics_session_serialize() but encodes the values from the metrics snapshot
+//! (see memfault_metrics_snapshot_iterate()) instead of the live ones
+bool memfault_metrics_session_serialize_snapshot(const sMemfaultEventStorageImpl *storage_impl,
+                                                 eMfltMetricsSessionIndex session);
+
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+//! Same as memfault_metrics_session_serialize() but encodes the values of the session instance
+//! behind 'handle'. Must be called with memfault_lock() held.
+bool memfault_metrics_session_instance_serialize(const sMemfaultEventStorageImpl *storage_impl,
+                                                 eMfltMetricsSessionIndex session,
+                                                 MemfaultMetricsSessionHandle handle);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -19,12 +19,6 @@
 extern "C" {
 #endif
 
-union MemfaultMetricValue {
-  uint32_t u32;
-  int32_t i32;
-  void *ptr;
-};
-
 typedef struct {
   MemfaultMetricId key;
   eMemfaultMetricType type;
@@ -44,6 +38,33 @@ typedef bool (*MemfaultMetricIteratorCallback)(void *ctx, const sMemfaultMetricI
 
 void memfault_metrics_heartbeat_iterate(MemfaultMetricIteratorCallback cb, void *ctx);
 
+//! Same as "memfault_metrics_heartbeat_iterate" but only visits the metrics of one session.
+//! The cost is proportional to the number of metrics in the session rather than the total
+//! number of metrics defined.
+void memfault_metrics_session_iterate(eMfltMetricsSessionIndex session_key,
+                                      MemfaultMetricIteratorCallback cb, void *ctx);
+
+//! Same as "memfault_metrics_session_iterate" but visits the copy of the session's metrics taken
+//! for serialization when MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT is enabled. Does not take
+//! memfault_lock(). Visits nothing if no snapshot of the session is pending.
+void memfault_metrics_snapshot_iterate(eMfltMetricsSessionIndex session_key,
+                                       MemfaultMetricIteratorCallback cb, void *ctx);
+
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+//! Same as "memfault_metrics_session_iterate" but visits the metrics of a session instance. Must
+//! be called with memfault_lock() held. Visits nothing if the handle is stale.
+void memfault_metrics_session_instance_iterate_nolock(MemfaultMetricsSessionHandle handle,
+                                                      MemfaultMetricIteratorCallback cb,
+                                                      void *ctx);
+#endif
+
+//! Get the min and max of the partial bucket of a time series, which are not yet part of its
+//! samples, in the order they were recorded.
+//!
+//! @return the number of samples written to 'out', 0 to 2
+size_t memfault_metrics_time_series_pending_samples(const sMemfaultMetricTimeSeries *time_series,
+                                                    sMemfaultMetricTimeSeriesSample out[2]);
+
 //! @return the number of metrics being required for a heartbeat
 size_t memfault_metrics_heartbeat_get_num_metrics(void);
 
@@ -82,6 +82,70 @@ void memfault_coredump_size_and_storage_capacity(size_t *total_size, size_t *cap
 //! @return true when a valid coredump is present in the storage.
 bool memfault_coredump_has_valid_coredump(size_t *total_size_out);
 
+//! Invalidates every coredump held in coredump storage
+//!
+//! Same as memfault_platform_coredump_storage_clear() unless MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS
+//! is greater than 1, in which case each slot is cleared with
+//! memfault_platform_coredump_storage_clear_slot().
+void memfault_coredump_storage_clear_all(void);
+
+#if MEMFAULT_COREDUMP_STORAGE_PRE_ERASE
+//! Erases the next sector of coredump storage so a future coredump save can skip erasing
+//!
+//! Intended to be called repeatedly from an idle or low priority task after a coredump has been
+//! drained (and on boot when no coredump is present) until it returns true. Storage holding a
+//! valid coredump is never erased.
+//!
+//! @note Coredump saves, including memfault_coredump_snapshot_commit(), reset the pre-erased
+//!  state themselves. Any other write to coredump storage (i.e the storage debug test) invalidates
+//!  it as well. Call memfault_coredump_storage_pre_erase_reset() after.
+//!
+//! @return true once the entire storage region has been erased, false while work remains or if
+//!  a valid coredump is present
+bool memfault_coredump_storage_pre_erase_step(void);
+
+//! Marks coredump storage as no longer pre-erased so the next save erases as it goes
+void memfault_coredump_storage_pre_erase_reset(void);
+#endif
+
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+typedef enum MemfaultCoredumpVerifyResult {
+  kMemfaultCoredumpVerifyResult_InProgress = 0,
+  kMemfaultCoredumpVerifyResult_Valid,
+  kMemfaultCoredumpVerifyResult_Corrupt,
+  kMemfaultCoredumpVerifyResult_NoCoredump,
+} eMemfaultCoredumpVerifyResult;
+
+//! Checks the CRC32 blocks of the coredump which will be uploaded next
+//!
+//! Intended to be called repeatedly from an idle or low priority task until it no longer returns
+//! kMemfaultCoredumpVerifyResult_InProgress. The result is kept until the coredump is drained so
+//! the coredump data source does not need to read it again. Coredumps saved by a build without
+//! MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED are reported as valid.
+//!
+//! @param max_bytes The most bytes of coredump storage to check in this call
+//!
+//! @return The result of the check so far
+eMemfaultCoredumpVerifyResult memfault_coredump_verify_step(size_t max_bytes);
+#endif
+
+#if MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0
+//! @return true if the fault handler saved a coredump to the RAM snapshot which has not been
+//!  committed to coredump storage yet
+bool memfault_coredump_snapshot_pending(void);
+
+//! Moves a coredump saved to the RAM snapshot by the fault handler into coredump storage
+//!
+//! Intended to be called from a background task after boot. Memory regions are run length
+//! encoded on the way when MEMFAULT_COREDUMP_COMPRESS_REGIONS is enabled and, when
+//! MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED is enabled, the snapshot is checked for corruption first.
+//! The snapshot is kept if coredump storage is still holding a coredump which has not been
+//! drained so the call can be retried later. Otherwise it is discarded, even if the commit fails.
+//!
+//! @return true if a snapshot was committed
+bool memfault_coredump_snapshot_commit(void);
+#endif
+
 //
 // Integration utilities
 //
@@ -109,6 +173,48 @@ bool memfault_coredump_storage_debug_test_begin(void);
 //!  to the CLI for further debug.
 bool memfault_coredump_storage_debug_test_finish(void);
 
+//! The write sizes, in bytes, profiled by memfault_coredump_storage_debug_profile()
+#define MEMFAULT_COREDUMP_STORAGE_PROFILE_WRITE_SIZES \
+  { 16, 64, 256 }
+#define MEMFAULT_COREDUMP_STORAGE_PROFILE_NUM_WRITE_SIZES 3
+
+typedef struct MemfaultCoredumpStorageProfile {
+  //! The number of bytes of coredump storage exercised by each operation
+  uint32_t storage_size;
+  //! Time to erase all of coredump storage
+  uint32_t erase_ms;
+  //! Time to write all of coredump storage with sequential writes of write_size[i] bytes
+  uint32_t write_size[MEMFAULT_COREDUMP_STORAGE_PROFILE_NUM_WRITE_SIZES];
+  uint32_t write_ms[MEMFAULT_COREDUMP_STORAGE_PROFILE_NUM_WRITE_SIZES];
+  //! Time to read all of coredump storage with memfault_coredump_read()
+  uint32_t read_ms;
+  //! The worst case coredump size for the configured regions
+  uint32_t save_size;
+  //! Estimated time to erase and write a save_size coredump from the fault handler. 0 with
+  //! MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE, where the fault handler only copies it to RAM.
+  uint32_t predicted_save_ms;
+  //! With MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE, estimated time for
+  //! memfault_coredump_snapshot_commit() to erase and write the snapshot to storage. 0 otherwise.
+  uint32_t predicted_commit_ms;
+} sMemfaultCoredumpStorageProfile;
+
+//! Times erase, write and read of the platform's coredump storage implementation and predicts
+//! how long saving a coredump for the configured regions takes
+//!
+//! @note Timing uses memfault_platform_get_time_since_boot_ms() so this routine must be called
+//!  with interrupts enabled and results are only meaningful for storage which takes several
+//!  milliseconds to erase or write. The contents of coredump storage are destroyed so it should
+//!  not be called while a valid coredump is present.
+//! @note Failures are recorded for memfault_coredump_storage_debug_test_finish() to report.
+//!
+//! @param profile Populated with the measurements
+//!
+//! @return true if all storage operations succeeded, false otherwise
+bool memfault_coredump_storage_debug_profile(sMemfaultCoredumpStorageProfile *profile);
+
+//! Logs the measurements collected by memfault_coredump_storage_debug_profile()
+void memfault_coredump_storage_debug_profile_print(const sMemfaultCoredumpStorageProfile *profile);
+
 #if MEMFAULT_CACHE_FAULT_REGS
 //! Defined in memfault_coredump_regions_armv7.c but needed for platform ports,
 //! like Zephyr, this function will allow the port to capture the ARM fault
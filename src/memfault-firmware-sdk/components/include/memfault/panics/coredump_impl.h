@@ -37,6 +37,13 @@ typedef enum MfltCoredumpBlockType {
   kMfltCoredumpRegionType_SoftwareVersion = 10,
   kMfltCoredumpRegionType_SoftwareType = 11,
   kMfltCoredumpRegionType_BuildId = 12,
+  //! A memory region saved run length encoded (see MEMFAULT_COREDUMP_COMPRESS_REGIONS)
+  kMfltCoredumpRegionType_MemoryRegionRle = 13,
+  //! Describes the thread stack saved in the memory region block which follows it
+  kMfltCoredumpRegionType_ThreadStackInfo = 14,
+  //! The CRC32 of everything written since the previous CRC32 block or the coredump header (see
+  //! MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED)
+  kMfltCoredumpRegionType_Crc32 = 15,
 } eMfltCoredumpBlockType;
 
 // All elements are in word-sized units for alignment-friendliness.
@@ -58,6 +65,10 @@ typedef struct MfltCachedBlock {
 //! @return The space required to save the coredump or 0 on error
 size_t memfault_coredump_get_save_size(const sMemfaultCoredumpSaveInfo *save_info);
 
+//! @return The space available for saving a single coredump. This is the size of the entire
+//! coredump storage region unless MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+size_t memfault_coredump_get_slot_size(void);
+
 //! @param num_regions The number of regions in the list returned
 //! @return regions to collect based on the active architecture or NULL if there are no extra
 //! regions to collect
@@ -18,6 +18,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "memfault-firmware-sdk/components/include/memfault/config.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/reboot_reason_types.h"
 
 #ifdef __cplusplus
@@ -33,6 +34,16 @@ typedef enum MfltCoredumpRegionType {
   kMfltCoredumpRegionType_ImageIdentifier,
   kMfltCoredumpRegionType_ArmV6orV7MpuUnrolled,
   kMfltCoredumpRegionType_CachedMemory,
+  //! A thread stack growing down from region_start + region_size. Only the part of the stack
+  //! which has been used is saved, i.e from the lowest word which no longer holds
+  //! MEMFAULT_COREDUMP_STACK_FILL_WORD up to the top of the stack. The high water mark is saved
+  //! alongside it in a kMfltCoredumpRegionType_ThreadStackInfo block, which the Memfault cloud
+  //! needs to support. Older coredump ingestion doesn't decode it.
+  //!
+  //! If the stack has to be cut short, the bytes nearest the top of the stack are kept. The lowest
+  //! addresses are dropped first since, below the thread's stack pointer, they only hold frames
+  //! of calls which have already returned.
+  kMfltCoredumpRegionType_ThreadStack,
 } eMfltCoredumpRegionType;
 
 //! Convenience macro to define a sMfltCoredumpRegion of type kMfltCoredumpRegionType_Memory.
@@ -41,10 +52,53 @@ typedef enum MfltCoredumpRegionType {
     .type = kMfltCoredumpRegionType_Memory, .region_start = _start, .region_size = _size, \
   }
 
+//! Convenience macro to define a sMfltCoredumpRegion of type kMfltCoredumpRegionType_Memory with
+//! a priority and guaranteed size used by the coredump region planner. See
+//! MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED for more details. The priority and guaranteed size are
+//! ignored when the planner is disabled.
+#if MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED
+  #define MEMFAULT_COREDUMP_MEMORY_REGION_WITH_PRIORITY_INIT(_start, _size, _priority,      \
+                                                             _guaranteed_size)              \
+    (sMfltCoredumpRegion) {                                                                 \
+      .type = kMfltCoredumpRegionType_Memory, .region_start = _start, .region_size = _size, \
+      .priority = _priority, .guaranteed_size = _guaranteed_size,                           \
+    }
+#else
+  #define MEMFAULT_COREDUMP_MEMORY_REGION_WITH_PRIORITY_INIT(_start, _size, _priority, \
+                                                             _guaranteed_size)         \
+    MEMFAULT_COREDUMP_MEMORY_REGION_INIT(_start, _size)
+#endif
+
+//! Convenience macro to define a sMfltCoredumpRegion of type kMfltCoredumpRegionType_ThreadStack.
+//!
+//! @note The stack is expected to be word aligned and to have been filled with
+//!  MEMFAULT_COREDUMP_STACK_FILL_WORD when the thread was created (i.e FreeRTOS does this with
+//!  0xa5 when stack overflow checking or uxTaskGetStackHighWaterMark() is enabled)
+#define MEMFAULT_COREDUMP_THREAD_STACK_REGION_INIT(_stack_base, _stack_size)                \
+  (sMfltCoredumpRegion) {                                                                   \
+    .type = kMfltCoredumpRegionType_ThreadStack, .region_start = _stack_base,               \
+    .region_size = _stack_size,                                                             \
+  }
+
 typedef struct MfltCoredumpRegion {
   eMfltCoredumpRegionType type;
   const void *region_start;
   uint32_t region_size;
+#if MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED
+  //! Only present when MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED=1, so region tables don't grow
+  //! when the planner is not used
+  //!
+  //! When coredump storage can not hold every region, space is handed out to regions with a
+  //! lower value first. Regions default to 0, the highest priority.
+  uint8_t priority;
+  //! Only present when MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED=1
+  //!
+  //! The number of bytes of the region which are budgeted for, in priority order, before the
+  //! remainder of any region is considered. They are counted from region_start (i.e the most
+  //! recent frames of a region beginning at the stack pointer), or down from the top of the
+  //! stack for a kMfltCoredumpRegionType_ThreadStack region.
+  uint32_t guaranteed_size;
+#endif
 } sMfltCoredumpRegion;
 
 typedef struct CoredumpCrashInfo {
@@ -136,8 +190,39 @@ bool memfault_platform_coredump_storage_erase(uint32_t offset, size_t erase_size
 //!
 //! @note a coredump region can be invalidated by zero'ing out or erasing the first sector
 //! being used for storage
+//! @note When MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1 this only invalidates the first slot. Use
+//! memfault_coredump_storage_clear_all() to invalidate every slot.
 void memfault_platform_coredump_storage_clear(void);
 
+//! Invalidate the coredump saved in one slot of the coredump storage region
+//!
+//! Only used when MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1. A weak version of this API is defined
+//! in memfault_coredump.c which erases the first sector of the slot, or zeroes out the magic of
+//! the coredump header when no sector size is reported or the erase fails. It can be overridden
+//! if the port has a cheaper way to invalidate the header at the start of the slot.
+//!
+//! @param slot_offset The offset of the slot within the coredump storage region
+extern void memfault_platform_coredump_storage_clear_slot(uint32_t slot_offset);
+
+//! Optional: Get a pointer to coredump storage when it is memory mapped (i.e internal flash or
+//! RAM backed storage)
+//!
+//! When implemented, coredumps are run length encoded for upload directly from storage rather
+//! than being copied out with memfault_coredump_read() first. A weak version of this API which
+//! returns false is defined in memfault_coredump.c.
+//!
+//! @note The pointer is used while the system is running so the storage must be safe to read
+//!  at any time
+//!
+//! @param offset The offset within coredump storage
+//! @param read_ptr Populated with a pointer to coredump storage at offset
+//! @param read_ptr_len Populated with the number of bytes from offset to the end of storage
+//!
+//! @return true if storage is memory mapped, false otherwise
+extern bool memfault_platform_coredump_storage_get_read_pointer(uint32_t offset,
+                                                                const void **read_ptr,
+                                                                size_t *read_ptr_len);
+
 //! Used to read coredumps out of storage when the system is not in a _crashed_ state
 //!
 //! @note A weak version of this API is defined in memfault_coredump.c and it will just use the
@@ -21,6 +21,12 @@
 extern "C" {
 #endif
 
+//! The number of bytes needed to encode the unsigned integer 'value', or the header of a string,
+//! array or dictionary of 'value' bytes or entries. A constant expression when 'value' is one.
+#define MEMFAULT_CBOR_UINT_ENCODED_SIZE(value)                           \
+  (((uint64_t)(value) < 24) ? 1 : ((uint64_t)(value) <= UINT8_MAX) ? 2 : \
+   ((uint64_t)(value) <= UINT16_MAX) ? 3 : ((uint64_t)(value) <= UINT32_MAX) ? 5 : 9)
+
 //! The context used to track an active cbor encoding operation
 //! A consumer of this API should never have to access the structure directly
 typedef struct MemfaultCborEncoder sMemfaultCborEncoder;
@@ -154,6 +160,14 @@ bool memfault_cbor_encode_uint64_as_double(sMemfaultCborEncoder *encoder, uint64
 //! @return true on success, false otherwise
 bool memfault_cbor_encode_long_signed_integer(sMemfaultCborEncoder *encoder, int64_t value);
 
+//! Called to encode an unsigned 64 bit data item
+//!
+//! @param encoder The encoder context to use
+//! @param value The value to store
+//!
+//! @return true on success, false otherwise
+bool memfault_cbor_encode_long_unsigned_integer(sMemfaultCborEncoder *encoder, uint64_t value);
+
 //! Encode a CBOR null value
 //!
 //! @param encoder The encoder context to use
@@ -0,0 +1,38 @@
+#pragma once
+
+//! @file
+//!
+//! Copyright (c) Memfault, Inc.
+//! See License.txt for details
+//!
+//! @brief
+//! C Implementation of the standard (ZIP file) CRC-32 polynomial:
+//!   x^32 + x^26 + x^23 + x^22 + x^16 + x^12 + x^11 + x^10 + x^8 + x^7 + x^5 + x^4 + x^2 + x + 1
+//! More details:
+//!   http://reveng.sourceforge.net/crc-catalogue/17plus.htm#crc.cat.crc-32-iso-hdlc
+//!
+//! Unlike memfault_platform_crc32(), the CRC can be computed incrementally which is needed when
+//! the data is not all available in one buffer
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define MEMFAULT_CRC32_INITIAL_VALUE 0x0
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+//! Computes the CRC32 value for the given sequence
+//!
+//! @param crc_initial_value Use MEMFAULT_CRC32_INITIAL_VALUE when computing a new checksum over
+//!  the entire data set passed in. Use the current CRC32 value if computing over a data set
+//!  incrementally
+//! @param data The data to compute the crc over
+//! @param data_len_bytes the length of the data to compute the crc over, in bytes
+uint32_t memfault_crc32_compute(uint32_t crc_initial_value, const void *data,
+                                size_t data_len_bytes);
+
+#ifdef __cplusplus
+}
+#endif
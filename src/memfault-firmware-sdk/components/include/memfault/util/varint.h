@@ -29,6 +29,14 @@ extern "C" {
 //! @return The number of bytes written into the buffer
 size_t memfault_encode_varint_u32(uint32_t value, void *buf);
 
+//! Decodes a Varint previously encoded with memfault_encode_varint_u32()
+//!
+//! @param[in] buf The buffer holding the Varint encoding
+//! @param[in] buf_len The number of bytes available in buf
+//! @param[out] value Populated with the decoded value on success
+//! @return The number of bytes consumed from buf or 0 if buf did not hold a complete encoding
+size_t memfault_decode_varint_u32(const void *buf, size_t buf_len, uint32_t *value);
+
 //! Given an int32_t, encodes it as a ZigZag varint
 //!
 //! @note a ZigZag varint can encode the range -2147483648 to 2147483647 and is an optimization
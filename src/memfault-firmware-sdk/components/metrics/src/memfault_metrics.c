@@ -45,6 +45,7 @@ MEMFAULT_DISABLE_WARNING("-Wunused-macros")
 #define MEMFAULT_METRICS_STORAGE_TOO_SMALL (-5)
 #define MEMFAULT_METRICS_TIMER_BOOT_FAILED (-6)
 #define MEMFAULT_METRICS_VALUE_NOT_SET (-7)
+#define MEMFAULT_METRICS_SESSION_INSTANCES_EXHAUSTED (-8)
 
 #define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type)
 #define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
@@ -199,6 +200,15 @@ static const sMemfaultMetricKVPair s_memfault_heartbeat_keys[] = {
 MEMFAULT_STATIC_ASSERT(MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys) != 0,
                        "At least one \"MEMFAULT_METRICS_KEY_DEFINE\" must be defined");
 
+// One bucket per possible bit length of a uint32_t sample (0-32) is the most that can be used
+MEMFAULT_STATIC_ASSERT((MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS >= 2) &&
+                         (MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS <= 33),
+                       "MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS must be between 2 and 33");
+
+MEMFAULT_STATIC_ASSERT((MEMFAULT_METRICS_HIGH_RES_TIMER_COUNTER_BITS >= 16) &&
+                         (MEMFAULT_METRICS_HIGH_RES_TIMER_COUNTER_BITS <= 64),
+                       "MEMFAULT_METRICS_HIGH_RES_TIMER_COUNTER_BITS must be between 16 and 64");
+
 #define MEMFAULT_METRICS_TIMER_VAL_MAX 0x80000000
 typedef struct MemfaultMetricValueMetadata {
   bool is_running:1;
@@ -226,22 +236,8 @@ typedef struct MemfaultMetricValueInfo {
 #undef MEMFAULT_METRICS_STRING_KEY_DEFINE
 #undef MEMFAULT_METRICS_STRING_KEY_DEFINE_
 
-// Generate a mapping of key index to key value position in s_memfault_heartbeat_values.
-// First produce a sparse enum for the key values that are stored in s_memfault_heartbeat_values.
-typedef enum MfltMetricKeyToValueIndex {
-#define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type) \
-  MEMFAULT_METRICS_KEY_DEFINE_(key_name, value_type)
-#define MEMFAULT_METRICS_KEY_DEFINE_(key_name, value_type) kMfltMetricKeyToValueIndex_##key_name,
-#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
-
-#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
-#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
-#undef MEMFAULT_METRICS_KEY_DEFINE
-#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
-#undef MEMFAULT_METRICS_KEY_DEFINE_
-  kMfltMetricKeyToValueIndex_Count
-} eMfltMetricKeyToValueIndex;
-// Now generate a table mapping the canonical key ID to the index in s_memfault_heartbeat_values
+// Generate a mapping of key index to key value position in g_memfault_heartbeat_values, using
+// the sparse eMfltMetricKeyToValueIndex enum generated in ids_impl.h
 static const eMfltMetricKeyToValueIndex s_memfault_heartbeat_key_to_valueindex[] = {
 #define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type) \
   MEMFAULT_METRICS_KEY_DEFINE_(key_name, value_type)
@@ -274,7 +270,7 @@ typedef enum MfltMetricStringKeyToIndex {
 #undef MEMFAULT_METRICS_STRING_KEY_DEFINE_
   kMfltMetricStringKeyToIndex_Count
 } eMfltMetricStringKeyToIndex;
-// Now generate a table mapping the canonical key ID to the index in s_memfault_heartbeat_values
+// Now generate a table mapping the canonical key ID to the index in g_memfault_heartbeat_values
 static const eMfltMetricStringKeyToIndex s_memfault_heartbeat_string_key_to_index[] = {
 #define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type) \
   (eMfltMetricStringKeyToIndex)0,  // 0 for the placeholder so it's safe to index with
@@ -291,30 +287,29 @@ MEMFAULT_STATIC_ASSERT(
     MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_string_key_to_index),
   "Mismatch between s_memfault_heartbeat_keys and s_memfault_heartbeat_string_key_to_index");
 
-// Generate heartbeat values table (RAM), sparsely populated: only for the scalar types
+// Generate heartbeat values table (RAM), sparsely populated: only for the scalar types. Not
+// static, so the fast-path macros in metrics.h can update values without a lookup.
 #define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type) { 0 },
 #define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
-static union MemfaultMetricValue s_memfault_heartbeat_values[] = {
+union MemfaultMetricValue g_memfault_heartbeat_values[] = {
 #include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
 #include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
 #undef MEMFAULT_METRICS_KEY_DEFINE
 #undef MEMFAULT_METRICS_STRING_KEY_DEFINE
 };
+MEMFAULT_STATIC_ASSERT(MEMFAULT_ARRAY_SIZE(g_memfault_heartbeat_values) ==
+                         kMfltMetricKeyToValueIndex_Count,
+                       "Mismatch between g_memfault_heartbeat_values and "
+                       "eMfltMetricKeyToValueIndex");
 
-// Value Set flag data structures and definitions
-// MEMFAULT_IS_SET_FLAGS_PER_BYTE must be a power of 2
-// MEMFAULT_IS_SET_FLAGS_DIVIDER must be equal to log2(MEMFAULT_IS_SET_FLAGS_PER_BYTE)
-#define MEMFAULT_IS_SET_FLAGS_PER_BYTE 8
-#define MEMFAULT_IS_SET_FLAGS_DIVIDER 3
-
-// Create a byte array to contain an is-set flag for each entry in s_memfault_heartbeat_values
-static uint8_t s_memfault_heatbeat_value_is_set_flags[MEMFAULT_CEIL_DIV(
-  MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_values), MEMFAULT_IS_SET_FLAGS_PER_BYTE)];
+// Create a byte array to contain an is-set flag for each entry in g_memfault_heartbeat_values
+uint8_t g_memfault_heartbeat_value_is_set_flags[MEMFAULT_CEIL_DIV(
+  MEMFAULT_ARRAY_SIZE(g_memfault_heartbeat_values), MEMFAULT_IS_SET_FLAGS_PER_BYTE)];
 
 MEMFAULT_STATIC_ASSERT(
-  MEMFAULT_ARRAY_SIZE(s_memfault_heatbeat_value_is_set_flags) >=
-    (MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_values) / MEMFAULT_IS_SET_FLAGS_PER_BYTE),
-  "Mismatch between s_memfault_heatbeat_value_is_set_flags and s_memfault_heartbeat_values");
+  MEMFAULT_ARRAY_SIZE(g_memfault_heartbeat_value_is_set_flags) >=
+    (MEMFAULT_ARRAY_SIZE(g_memfault_heartbeat_values) / MEMFAULT_IS_SET_FLAGS_PER_BYTE),
+  "Mismatch between g_memfault_heartbeat_value_is_set_flags and g_memfault_heartbeat_values");
 
 // String value lookup table. Const- the pointers do not change at runtime, so
 // this table can be stored in ROM and save a little RAM.
@@ -333,8 +328,13 @@ static const union MemfaultMetricValue s_memfault_heartbeat_string_values[] = {
 // Timer metadata table
 #define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name)
 #define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name)
 #define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
 #define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name) { 0 },
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name)
 #define MEMFAULT_METRICS_KEY_DEFINE(_name, _type) MEMFAULT_METRICS_STATE_HELPER_##_type(_name)
 static sMemfaultMetricValueMetadata s_memfault_heartbeat_timer_values_metadata[] = {
 #include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
@@ -347,6 +347,11 @@ static sMemfaultMetricValueMetadata s_memfault_heartbeat_timer_values_metadata[]
 // Work-around for unused-macros error in case not all types are used in the .def file:
 MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_)
   MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_)
+    MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_)
+      MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_)
+        MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_)
+          MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_)
+            MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_)
 
 // We need a key-index table of pointers to timer metadata for fast lookups.
 // The enum eMfltMetricsTimerIndex will create a subset of indexes for use
@@ -369,19 +374,371 @@ MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_)
 
 #undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
 #undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
 #undef MEMFAULT_METRICS_STRING_KEY_DEFINE
 
 #define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name) -1,
 #define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name) -1,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name) -1,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name) -1,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name) -1,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name) -1,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name) -1,
 #define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length) -1,
 
 static const int s_metric_timer_metadata_mapping[] = {
 #include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
 #include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+};
+
+// Histogram state doesn't fit in a union MemfaultMetricValue, so like strings, each histogram
+// metric gets its own storage and is accessed through a pointer. First allocate the storage:
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name) \
+  static sMemfaultMetricHistogram g_memfault_metrics_histogram_##_name;
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+
+// Then a dense index for the histogram metrics
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name) \
+  kMfltMetricHistogramKeyToIndex_##_name,
+typedef enum MfltMetricHistogramKeyToIndex {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+  kMfltMetricHistogramKeyToIndex_Count
+} eMfltMetricHistogramKeyToIndex;
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+
+// And the table mapping the canonical key ID to the index in s_memfault_heartbeat_histogram_values
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name) \
+  (eMfltMetricHistogramKeyToIndex)0,  // 0 for the placeholder so it's safe to index with
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name) \
+  (eMfltMetricHistogramKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name) \
+  (eMfltMetricHistogramKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name) \
+  (eMfltMetricHistogramKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name) \
+  (eMfltMetricHistogramKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name) \
+  (eMfltMetricHistogramKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name) \
+  (eMfltMetricHistogramKeyToIndex)0,
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length) \
+  (eMfltMetricHistogramKeyToIndex)0,
+static const eMfltMetricHistogramKeyToIndex s_memfault_heartbeat_histogram_key_to_index[] = {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+};
+MEMFAULT_STATIC_ASSERT(
+  MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys) ==
+    MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_histogram_key_to_index),
+  "Mismatch between s_memfault_heartbeat_keys and s_memfault_heartbeat_histogram_key_to_index");
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+
+// Histogram value lookup table. Const, the pointers do not change at runtime.
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name) \
+  { .ptr = &g_memfault_metrics_histogram_##_name },
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
+static const union MemfaultMetricValue s_memfault_heartbeat_histogram_values[] = {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_KEY_DEFINE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+  // include a stub entry to prevent compilation errors when no histograms are defined
+  { .ptr = NULL },
+};
+
+// High resolution timers keep a 64-bit total and start count, which don't fit in a union
+// MemfaultMetricValue either, so they are stored the same way as histograms
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name) \
+  static sMemfaultMetricHighResTimer g_memfault_metrics_high_res_timer_##_name;
+#define MEMFAULT_METRICS_KEY_DEFINE(_name, _type) MEMFAULT_METRICS_STATE_HELPER_##_type(_name)
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name) \
+  kMfltMetricHighResTimerKeyToIndex_##_name,
+typedef enum MfltMetricHighResTimerKeyToIndex {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+  kMfltMetricHighResTimerKeyToIndex_Count
+} eMfltMetricHighResTimerKeyToIndex;
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name) \
+  (eMfltMetricHighResTimerKeyToIndex)0,  // 0 for the placeholder so it's safe to index with
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name) \
+  (eMfltMetricHighResTimerKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name) \
+  (eMfltMetricHighResTimerKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name) \
+  (eMfltMetricHighResTimerKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name) \
+  (eMfltMetricHighResTimerKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name) \
+  (eMfltMetricHighResTimerKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name) \
+  (eMfltMetricHighResTimerKeyToIndex)0,
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length) \
+  (eMfltMetricHighResTimerKeyToIndex)0,
+static const eMfltMetricHighResTimerKeyToIndex
+  s_memfault_heartbeat_high_res_timer_key_to_index[] = {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+};
+MEMFAULT_STATIC_ASSERT(MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys) ==
+                         MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_high_res_timer_key_to_index),
+                       "Mismatch between s_memfault_heartbeat_keys and "
+                       "s_memfault_heartbeat_high_res_timer_key_to_index");
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+
+// High resolution timer value lookup table. Const, the pointers do not change at runtime.
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name) \
+  { .ptr = &g_memfault_metrics_high_res_timer_##_name },
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
+static const union MemfaultMetricValue s_memfault_heartbeat_high_res_timer_values[] = {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_KEY_DEFINE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+  // include a stub entry to prevent compilation errors when no high resolution timers are defined
+  { .ptr = NULL },
+};
+
+// 64-bit integer values don't fit in a union MemfaultMetricValue either. Their storage is
+// g_memfault_heartbeat_values64, indexed by the dense eMfltMetricValue64Index enum from ids_impl.h
+// so the fast-path macros can reach it, and is otherwise accessed through a pointer the same way
+// as histograms. +1 to prevent a zero length array when no 64-bit metrics are defined.
+sMemfaultMetricValue64 g_memfault_heartbeat_values64[kMfltMetricValue64Index_Count + 1];
+
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name) \
+  (eMfltMetricValue64Index)0,  // 0 for the placeholder so it's safe to index with
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name) \
+  (eMfltMetricValue64Index)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name) \
+  (eMfltMetricValue64Index)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name) \
+  (eMfltMetricValue64Index)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name) \
+  (eMfltMetricValue64Index)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name) \
+  (eMfltMetricValue64Index)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name) \
+  kMfltMetricValue64Index_##_name,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name) \
+  kMfltMetricValue64Index_##_name,
+#define MEMFAULT_METRICS_KEY_DEFINE(_name, _type) MEMFAULT_METRICS_STATE_HELPER_##_type(_name)
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length) (eMfltMetricValue64Index)0,
+static const eMfltMetricValue64Index s_memfault_heartbeat_value64_key_to_index[] = {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+};
+MEMFAULT_STATIC_ASSERT(
+  MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys) ==
+    MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_value64_key_to_index),
+  "Mismatch between s_memfault_heartbeat_keys and s_memfault_heartbeat_value64_key_to_index");
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+
+// 64-bit value lookup table. Const, the pointers do not change at runtime.
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name) \
+  { .ptr = &g_memfault_heartbeat_values64[kMfltMetricValue64Index_##_name] },
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name) \
+  { .ptr = &g_memfault_heartbeat_values64[kMfltMetricValue64Index_##_name] },
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
+static const union MemfaultMetricValue s_memfault_heartbeat_value64_values[] = {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_KEY_DEFINE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+  // include a stub entry to prevent compilation errors when no 64-bit metrics are defined
+  { .ptr = NULL },
+};
+
+// Time series are held outside of the value union too, the same way as histograms
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name)
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name) \
+  static sMemfaultMetricTimeSeries g_memfault_metrics_time_series_##_name;
+#define MEMFAULT_METRICS_KEY_DEFINE(_name, _type) MEMFAULT_METRICS_STATE_HELPER_##_type(_name)
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name) \
+  kMfltMetricTimeSeriesKeyToIndex_##_name,
+typedef enum MfltMetricTimeSeriesKeyToIndex {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+  kMfltMetricTimeSeriesKeyToIndex_Count
+} eMfltMetricTimeSeriesKeyToIndex;
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name) \
+  (eMfltMetricTimeSeriesKeyToIndex)0,  // 0 for the placeholder so it's safe to index with
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name) \
+  (eMfltMetricTimeSeriesKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name) \
+  (eMfltMetricTimeSeriesKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name) \
+  (eMfltMetricTimeSeriesKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name) \
+  (eMfltMetricTimeSeriesKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name) \
+  (eMfltMetricTimeSeriesKeyToIndex)0,
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name) \
+  (eMfltMetricTimeSeriesKeyToIndex)0,
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length) \
+  (eMfltMetricTimeSeriesKeyToIndex)0,
+static const eMfltMetricTimeSeriesKeyToIndex s_memfault_heartbeat_time_series_key_to_index[] = {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+};
+MEMFAULT_STATIC_ASSERT(
+  MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys) ==
+    MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_time_series_key_to_index),
+  "Mismatch between s_memfault_heartbeat_keys and s_memfault_heartbeat_time_series_key_to_index");
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64
+#undef MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+
+// Time series value lookup table. Const, the pointers do not change at runtime.
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Timer(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Histogram(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_HighResTimer(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Unsigned64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_Signed64(_name)
+#define MEMFAULT_METRICS_STATE_HELPER_kMemfaultMetricType_TimeSeries(_name) \
+  { .ptr = &g_memfault_metrics_time_series_##_name },
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length)
+static const union MemfaultMetricValue s_memfault_heartbeat_time_series_values[] = {
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
 #undef MEMFAULT_METRICS_KEY_DEFINE
 #undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+  // include a stub entry to prevent compilation errors when no time series are defined
+  { .ptr = NULL },
 };
 
+// Counter deltas are taken modulo the width of the platform counter, so it may wrap
+#if MEMFAULT_METRICS_HIGH_RES_TIMER_COUNTER_BITS >= 64
+  #define MEMFAULT_METRICS_HIGH_RES_TIMER_MASK UINT64_MAX
+#else
+  #define MEMFAULT_METRICS_HIGH_RES_TIMER_MASK \
+    ((UINT64_C(1) << MEMFAULT_METRICS_HIGH_RES_TIMER_COUNTER_BITS) - 1)
+#endif
+
 // Helper macros to convert between the various metrics indices
 #define MEMFAULT_METRICS_ID_TO_KEY(id) ((size_t)(id)._impl)
 #define MEMFAULT_METRICS_KEY_TO_KV_INDEX(key) (s_memfault_heartbeat_key_to_valueindex[(key)])
@@ -392,6 +749,150 @@ static struct {
   const sMemfaultEventStorageImpl *storage_impl;
 } s_memfault_metrics_ctx;
 
+// Number of sessions, including the heartbeat session which is always the last one
+#define MEMFAULT_METRICS_NUM_SESSIONS (MEMFAULT_METRICS_SESSION_KEY(heartbeat) + 1)
+
+MEMFAULT_STATIC_ASSERT(MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys) <= UINT16_MAX,
+                       "Too many metrics defined to index with a uint16_t");
+
+// Key indices grouped by session, so serializing or resetting a session only visits the metrics
+// of that session instead of every metric defined. The preprocessor can't sort the X-macro
+// tables by session, so the lists are built once, on first use, with a counting sort.
+static struct {
+  bool initialized;
+  // The keys for session 's' are key_indices[offsets[s]] up to key_indices[offsets[s + 1] - 1]
+  uint16_t offsets[MEMFAULT_METRICS_NUM_SESSIONS + 1];
+  uint16_t key_indices[MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys)];
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+  // Position of each metric in its session, which indexes the values of a session instance
+  uint16_t positions[MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys)];
+#endif
+} s_memfault_metrics_session_keys;
+
+static void prv_session_keys_init(void) {
+  if (s_memfault_metrics_session_keys.initialized) {
+    return;
+  }
+
+  uint16_t *offsets = s_memfault_metrics_session_keys.offsets;
+  memset(offsets, 0, sizeof(s_memfault_metrics_session_keys.offsets));
+  for (size_t idx = 0; idx < MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys); idx++) {
+    offsets[s_memfault_heartbeat_keys[idx].session_key + 1]++;
+  }
+  for (size_t session = 0; session < MEMFAULT_METRICS_NUM_SESSIONS; session++) {
+    offsets[session + 1] += offsets[session];
+  }
+
+  // Fill in each session's range in key order, so sessions serialize in the same order as before
+  uint16_t next[MEMFAULT_METRICS_NUM_SESSIONS];
+  memcpy(next, offsets, sizeof(next));
+  for (size_t idx = 0; idx < MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys); idx++) {
+    const eMfltMetricsSessionIndex session = s_memfault_heartbeat_keys[idx].session_key;
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+    s_memfault_metrics_session_keys.positions[idx] = (uint16_t)(next[session] - offsets[session]);
+#endif
+    s_memfault_metrics_session_keys.key_indices[next[session]++] = (uint16_t)idx;
+  }
+
+  s_memfault_metrics_session_keys.initialized = true;
+}
+
+#if MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+// Total size of all string metrics, including their NUL terminators
+#define MEMFAULT_METRICS_KEY_DEFINE(key_name, value_type)
+#define MEMFAULT_METRICS_STRING_KEY_DEFINE(key_name, max_length) +((max_length) + 1)
+enum {
+  kMfltMetricsSnapshotStringBytes = 0
+#include "memfault-firmware-sdk/components/include/memfault/metrics/heartbeat_config.def"
+#include MEMFAULT_METRICS_USER_HEARTBEAT_DEFS_FILE
+};
+#undef MEMFAULT_METRICS_KEY_DEFINE
+#undef MEMFAULT_METRICS_STRING_KEY_DEFINE
+
+// Copy of one session's metrics, taken under the lock so the event can be encoded into storage
+// without holding it. values[] and is_set_flags[] are indexed by the position of the metric in
+// its session, strings and the values held outside of the value union are packed in the order
+// they are visited.
+static struct {
+  bool in_use;
+  eMfltMetricsSessionIndex session_key;
+  union MemfaultMetricValue values[MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys)];
+  uint8_t is_set_flags[MEMFAULT_CEIL_DIV(MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys),
+                                         MEMFAULT_IS_SET_FLAGS_PER_BYTE)];
+  // +1 to prevent zero length arrays when no strings or histograms are defined
+  char strings[kMfltMetricsSnapshotStringBytes + 1];
+  sMemfaultMetricHistogram histograms[kMfltMetricHistogramKeyToIndex_Count + 1];
+  sMemfaultMetricHighResTimer high_res_timers[kMfltMetricHighResTimerKeyToIndex_Count + 1];
+  sMemfaultMetricValue64 values64[kMfltMetricValue64Index_Count + 1];
+  sMemfaultMetricTimeSeries time_series[kMfltMetricTimeSeriesKeyToIndex_Count + 1];
+  // Sessions which ended (or heartbeat ticks which fired) while the snapshot was in use,
+  // serialized by its owner before release
+  bool end_pending[MEMFAULT_ARRAY_SIZE(s_session_end_cbs)];
+} s_memfault_metrics_snapshot;
+#endif
+
+// Metric lookups take the session instance whose bank they resolve to, or NULL for the global
+// heartbeat and session values. Only instances can be passed with session instances enabled.
+typedef struct MfltMetricsSessionInstance sMfltMetricsSessionInstance;
+
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+MEMFAULT_STATIC_ASSERT(MEMFAULT_METRICS_SESSION_MAX_INSTANCES <= UINT8_MAX,
+                       "MEMFAULT_METRICS_SESSION_MAX_INSTANCES must be at most 255");
+
+// Every region of an instance's value bank starts on this alignment, enough for uint64_t fields
+  #define MEMFAULT_METRICS_BANK_ALIGNMENT 8
+  #define MEMFAULT_METRICS_BANK_ALIGN(size) \
+    (MEMFAULT_CEIL_DIV(size, MEMFAULT_METRICS_BANK_ALIGNMENT) * MEMFAULT_METRICS_BANK_ALIGNMENT)
+
+// The value banks of the active session instances are carved out of this arena. A bank holds the
+// value union, the timer state and the is_set bit of every metric of the session, indexed by
+// the position of the metric in the session, followed by the storage the value unions of
+// strings, histograms and the other non-scalar metrics point to.
+static uint64_t s_memfault_metrics_instance_arena[MEMFAULT_CEIL_DIV(
+  MEMFAULT_METRICS_SESSION_INSTANCES_ARENA_SIZE, sizeof(uint64_t))];
+
+struct MfltMetricsSessionInstance {
+  bool in_use;
+  // Bumped every time the slot is reused, so a stale handle can't reach the next instance
+  uint8_t generation;
+  eMfltMetricsSessionIndex session_key;
+  uint32_t offset;
+  uint32_t size;
+};
+
+static sMfltMetricsSessionInstance
+  s_memfault_metrics_instances[MEMFAULT_METRICS_SESSION_MAX_INSTANCES];
+
+typedef struct MfltMetricsSessionBank {
+  union MemfaultMetricValue *values;
+  sMemfaultMetricValueMetadata *timers;
+  uint8_t *is_set_flags;
+} sMfltMetricsSessionBank;
+
+static size_t prv_session_instance_header_size(size_t num_metrics) {
+  const size_t is_set_flags_size = MEMFAULT_CEIL_DIV(num_metrics, MEMFAULT_IS_SET_FLAGS_PER_BYTE);
+  return MEMFAULT_METRICS_BANK_ALIGN(num_metrics * sizeof(union MemfaultMetricValue)) +
+         MEMFAULT_METRICS_BANK_ALIGN(num_metrics * sizeof(sMemfaultMetricValueMetadata) +
+                                     is_set_flags_size);
+}
+
+static sMfltMetricsSessionBank prv_session_instance_bank(
+  const sMfltMetricsSessionInstance *instance) {
+  const uint16_t *offsets = s_memfault_metrics_session_keys.offsets;
+  const size_t num_metrics =
+    (size_t)(offsets[instance->session_key + 1] - offsets[instance->session_key]);
+  uint8_t *bank = (uint8_t *)s_memfault_metrics_instance_arena + instance->offset;
+  uint8_t *timers =
+    bank + MEMFAULT_METRICS_BANK_ALIGN(num_metrics * sizeof(union MemfaultMetricValue));
+
+  return (sMfltMetricsSessionBank){
+    .values = (union MemfaultMetricValue *)(void *)bank,
+    .timers = (sMemfaultMetricValueMetadata *)(void *)timers,
+    .is_set_flags = timers + num_metrics * sizeof(sMemfaultMetricValueMetadata),
+  };
+}
+#endif
+
 //
 // Routines which can be overridden by customers
 //
@@ -400,6 +901,10 @@ MEMFAULT_WEAK void memfault_metrics_heartbeat_collect_data(void) { }
 
 MEMFAULT_WEAK void memfault_metrics_heartbeat_collect_sdk_data(void) { }
 
+MEMFAULT_WEAK uint64_t memfault_platform_metrics_high_res_timer_read(void) {
+  return memfault_platform_get_time_since_boot_ms() * 1000;
+}
+
 // This function calls built in metrics collection functions.
 static void prv_collect_builtin_data(void) {
   memfault_metrics_reliability_collect();
@@ -426,35 +931,87 @@ static sMemfaultMetricValueMetadata *prv_find_timer_metadatap(eMfltMetricsIndex
 
 //! Helper function to read/write is_set bits for the provided metric
 //!
+//! @param instance Session instance holding the metric, NULL for the global values
 //! @param id Metric ID to select corresponding is_set field
 //! @param write Boolean to control whether to write 1 to is_set
 //! @return Returns the value of metric's is_set field. The updated value is returned if write =
 //! true
-static bool prv_read_write_is_value_set(MemfaultMetricId id, bool write) {
-  // Shift the kv index by MEMFAULT_IS_SET_FLAGS_DIVIDER to select byte within
-  // s_memfault_heartbeat_value_is_set_flags
-  size_t byte_index = MEMFAULT_METRICS_ID_TO_KV_INDEX(id) >> MEMFAULT_IS_SET_FLAGS_DIVIDER;
-  // Modulo the kv index by MEMFAULT_IS_SET_FLAGS_PER_BYTE to get bit of the selected byte
-  size_t bit_index = MEMFAULT_METRICS_ID_TO_KV_INDEX(id) % MEMFAULT_IS_SET_FLAGS_PER_BYTE;
+static bool prv_read_write_is_value_set(const sMfltMetricsSessionInstance *instance,
+                                        MemfaultMetricId id, bool write) {
+  uint8_t *is_set_flags = g_memfault_heartbeat_value_is_set_flags;
+  size_t flag_index = MEMFAULT_METRICS_ID_TO_KV_INDEX(id);
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+  if (instance != NULL) {
+    is_set_flags = prv_session_instance_bank(instance).is_set_flags;
+    flag_index = s_memfault_metrics_session_keys.positions[MEMFAULT_METRICS_ID_TO_KEY(id)];
+  }
+#else
+  (void)instance;
+#endif
+
+  // Shift the flag index by MEMFAULT_IS_SET_FLAGS_DIVIDER to select byte within is_set_flags
+  size_t byte_index = flag_index >> MEMFAULT_IS_SET_FLAGS_DIVIDER;
+  // Modulo the flag index by MEMFAULT_IS_SET_FLAGS_PER_BYTE to get bit of the selected byte
+  size_t bit_index = flag_index % MEMFAULT_IS_SET_FLAGS_PER_BYTE;
 
   if (write) {
-    s_memfault_heatbeat_value_is_set_flags[byte_index] |= (1 << bit_index);
+    is_set_flags[byte_index] |= (1 << bit_index);
   }
 
-  return (s_memfault_heatbeat_value_is_set_flags[byte_index] >> bit_index) & 0x01;
+  return (is_set_flags[byte_index] >> bit_index) & 0x01;
 }
 
 static void prv_clear_is_value_set(eMfltMetricKeyToValueIndex key) {
   // Shift the kv index by MEMFAULT_IS_SET_FLAGS_DIVIDER to select byte within
-  // s_memfault_heartbeat_value_is_set_flags
+  // g_memfault_heartbeat_value_is_set_flags
   size_t byte_index = key >> MEMFAULT_IS_SET_FLAGS_DIVIDER;
   // Modulo the kv index by MEMFAULT_IS_SET_FLAGS_PER_BYTE to get bit of the selected byte
   size_t bit_index = key % MEMFAULT_IS_SET_FLAGS_PER_BYTE;
 
-  s_memfault_heatbeat_value_is_set_flags[byte_index] &= ~(1 << bit_index);
+  g_memfault_heartbeat_value_is_set_flags[byte_index] &= ~(1 << bit_index);
+}
+
+//! Fill in value_info->is_set for the types which track it
+static void prv_find_is_value_set(const sMfltMetricsSessionInstance *instance, MemfaultMetricId id,
+                                  eMemfaultMetricType key_type,
+                                  sMemfaultMetricValueInfo *value_info) {
+  if (key_type == kMemfaultMetricType_Unsigned || key_type == kMemfaultMetricType_Signed ||
+      key_type == kMemfaultMetricType_Unsigned64 || key_type == kMemfaultMetricType_Signed64) {
+    value_info->is_set = prv_read_write_is_value_set(instance, id, false);
+  } else if (key_type == kMemfaultMetricType_Histogram) {
+    value_info->is_set = ((sMemfaultMetricHistogram *)value_info->valuep->ptr)->count != 0;
+  } else if (key_type == kMemfaultMetricType_TimeSeries) {
+    const sMemfaultMetricTimeSeries *time_series = value_info->valuep->ptr;
+    value_info->is_set = (time_series->num_samples != 0) || (time_series->bucket_count != 0);
+  }
+}
+
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+//! prv_find_value_for_key() for a session instance. Metrics of other sessions are not found.
+static eMemfaultMetricType prv_session_instance_find_value(
+  const sMfltMetricsSessionInstance *instance, MemfaultMetricId id,
+  sMemfaultMetricValueInfo *value_info_out) {
+  const size_t idx = MEMFAULT_METRICS_ID_TO_KEY(id);
+  const sMemfaultMetricKVPair *const kv_pair = &s_memfault_heartbeat_keys[idx];
+  if (kv_pair->session_key != instance->session_key) {
+    *value_info_out = (sMemfaultMetricValueInfo){ 0 };
+    return kMemfaultMetricType_NumTypes;
+  }
+
+  const sMfltMetricsSessionBank bank = prv_session_instance_bank(instance);
+  const size_t pos = s_memfault_metrics_session_keys.positions[idx];
+  *value_info_out = (sMemfaultMetricValueInfo){
+    .valuep = &bank.values[pos],
+    .meta_datap = (kv_pair->type == kMemfaultMetricType_Timer) ? &bank.timers[pos] : NULL,
+  };
+  prv_find_is_value_set(instance, id, kv_pair->type, value_info_out);
+
+  return kv_pair->type;
 }
+#endif
 
-static eMemfaultMetricType prv_find_value_for_key(MemfaultMetricId id,
+static eMemfaultMetricType prv_find_value_for_key(const sMfltMetricsSessionInstance *instance,
+                                                  MemfaultMetricId id,
                                                   sMemfaultMetricValueInfo *value_info_out) {
   const size_t idx = MEMFAULT_METRICS_ID_TO_KEY(id);
   if (idx >= MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys)) {
@@ -462,11 +1019,19 @@ static eMemfaultMetricType prv_find_value_for_key(MemfaultMetricId id,
     return kMemfaultMetricType_NumTypes;
   }
 
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+  if (instance != NULL) {
+    return prv_session_instance_find_value(instance, id, value_info_out);
+  }
+#else
+  (void)instance;
+#endif
+
   // get the index for the value matching this key.
   eMfltMetricKeyToValueIndex key_index = MEMFAULT_METRICS_KEY_TO_KV_INDEX(idx);
   // for scalar types, this will be the returned value pointer. non-scalars
   // will be handled in the switch below
-  union MemfaultMetricValue *value_ptr = &s_memfault_heartbeat_values[key_index];
+  union MemfaultMetricValue *value_ptr = &g_memfault_heartbeat_values[key_index];
 
   eMemfaultMetricType key_type = s_memfault_heartbeat_keys[idx].type;
   switch (key_type) {
@@ -481,6 +1046,36 @@ static eMemfaultMetricType prv_find_value_for_key(MemfaultMetricId id,
 
     } break;
 
+    case kMemfaultMetricType_Histogram: {
+      // same as strings above, the histogram state is held outside of the value union
+      eMfltMetricHistogramKeyToIndex histogram_key_index =
+        s_memfault_heartbeat_histogram_key_to_index[idx];
+      value_ptr = (union MemfaultMetricValue
+                     *)(uintptr_t)&s_memfault_heartbeat_histogram_values[histogram_key_index];
+    } break;
+
+    case kMemfaultMetricType_HighResTimer: {
+      eMfltMetricHighResTimerKeyToIndex high_res_timer_key_index =
+        s_memfault_heartbeat_high_res_timer_key_to_index[idx];
+      value_ptr =
+        (union MemfaultMetricValue
+           *)(uintptr_t)&s_memfault_heartbeat_high_res_timer_values[high_res_timer_key_index];
+    } break;
+
+    case kMemfaultMetricType_Unsigned64:
+    case kMemfaultMetricType_Signed64: {
+      eMfltMetricValue64Index value64_key_index = s_memfault_heartbeat_value64_key_to_index[idx];
+      value_ptr = (union MemfaultMetricValue
+                     *)(uintptr_t)&s_memfault_heartbeat_value64_values[value64_key_index];
+    } break;
+
+    case kMemfaultMetricType_TimeSeries: {
+      eMfltMetricTimeSeriesKeyToIndex time_series_key_index =
+        s_memfault_heartbeat_time_series_key_to_index[idx];
+      value_ptr = (union MemfaultMetricValue
+                     *)(uintptr_t)&s_memfault_heartbeat_time_series_values[time_series_key_index];
+    } break;
+
     case kMemfaultMetricType_Timer:
     case kMemfaultMetricType_Signed:
     case kMemfaultMetricType_Unsigned:
@@ -493,24 +1088,43 @@ static eMemfaultMetricType prv_find_value_for_key(MemfaultMetricId id,
     .valuep = value_ptr,
     .meta_datap = prv_find_timer_metadatap((eMfltMetricsIndex)idx),
   };
-
-  if (key_type == kMemfaultMetricType_Unsigned || key_type == kMemfaultMetricType_Signed) {
-    value_info_out->is_set = prv_read_write_is_value_set(id, false);
-  }
+  prv_find_is_value_set(NULL, id, key_type, value_info_out);
 
   return key_type;
 }
 
 typedef bool (*MemfaultMetricKvIteratorCb)(void *ctx, const sMemfaultMetricKVPair *kv_pair,
                                            const sMemfaultMetricValueInfo *value_info);
+static bool prv_metric_iterator_visit(const sMfltMetricsSessionInstance *instance, size_t idx,
+                                      void *ctx, MemfaultMetricKvIteratorCb cb) {
+  const sMemfaultMetricKVPair *const kv_pair = &s_memfault_heartbeat_keys[idx];
+  sMemfaultMetricValueInfo value_info = { 0 };
+
+  (void)prv_find_value_for_key(instance, kv_pair->key, &value_info);
+
+  return cb(ctx, kv_pair, &value_info);
+}
+
 static void prv_metric_iterator(void *ctx, MemfaultMetricKvIteratorCb cb) {
   for (uint32_t idx = 0; idx < MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys); ++idx) {
-    const sMemfaultMetricKVPair *const kv_pair = &s_memfault_heartbeat_keys[idx];
-    sMemfaultMetricValueInfo value_info = { 0 };
+    bool do_continue = prv_metric_iterator_visit(NULL, idx, ctx, cb);
 
-    (void)prv_find_value_for_key(kv_pair->key, &value_info);
+    if (!do_continue) {
+      break;
+    }
+  }
+}
 
-    bool do_continue = cb(ctx, kv_pair, &value_info);
+//! Same as prv_metric_iterator() but only visits the metrics of one session, in the bank of
+//! 'instance' if it is not NULL
+static void prv_session_metric_iterator(const sMfltMetricsSessionInstance *instance,
+                                        eMfltMetricsSessionIndex session_key, void *ctx,
+                                        MemfaultMetricKvIteratorCb cb) {
+  prv_session_keys_init();
+  const uint16_t *offsets = s_memfault_metrics_session_keys.offsets;
+  for (size_t i = offsets[session_key]; i < offsets[session_key + 1]; ++i) {
+    bool do_continue =
+      prv_metric_iterator_visit(instance, s_memfault_metrics_session_keys.key_indices[i], ctx, cb);
 
     if (!do_continue) {
       break;
@@ -527,9 +1141,10 @@ static const sMemfaultMetricKVPair *prv_find_kvpair_for_key(MemfaultMetricId key
   return &s_memfault_heartbeat_keys[idx];
 }
 
-static int prv_find_value_info_for_type(MemfaultMetricId key, eMemfaultMetricType expected_type,
+static int prv_find_value_info_for_type(const sMfltMetricsSessionInstance *instance,
+                                        MemfaultMetricId key, eMemfaultMetricType expected_type,
                                         sMemfaultMetricValueInfo *value_info) {
-  const eMemfaultMetricType type = prv_find_value_for_key(key, value_info);
+  const eMemfaultMetricType type = prv_find_value_for_key(instance, key, value_info);
   if (value_info->valuep == NULL) {
     return MEMFAULT_METRICS_KEY_NOT_FOUND;
   }
@@ -541,21 +1156,32 @@ static int prv_find_value_info_for_type(MemfaultMetricId key, eMemfaultMetricTyp
   return 0;
 }
 
-static void prv_set_value_for_key(MemfaultMetricId key, union MemfaultMetricValue *new_value,
+static uint64_t prv_value64_read(const sMemfaultMetricValue64 *value64) {
+  return ((uint64_t)value64->hi << 32) | value64->lo;
+}
+
+static void prv_value64_write(sMemfaultMetricValue64 *value64, uint64_t value) {
+  value64->lo = (uint32_t)value;
+  value64->hi = (uint32_t)(value >> 32);
+}
+
+static void prv_set_value_for_key(const sMfltMetricsSessionInstance *instance,
+                                  MemfaultMetricId key, union MemfaultMetricValue *new_value,
                                   sMemfaultMetricValueInfo *value_info) {
   *value_info->valuep = *new_value;
-  prv_read_write_is_value_set(key, true);
+  prv_read_write_is_value_set(instance, key, true);
 }
 
-static int prv_find_and_set_value_for_key(MemfaultMetricId key, eMemfaultMetricType expected_type,
+static int prv_find_and_set_value_for_key(const sMfltMetricsSessionInstance *instance,
+                                          MemfaultMetricId key, eMemfaultMetricType expected_type,
                                           union MemfaultMetricValue *new_value) {
   sMemfaultMetricValueInfo value_info = { 0 };
-  int rv = prv_find_value_info_for_type(key, expected_type, &value_info);
+  int rv = prv_find_value_info_for_type(instance, key, expected_type, &value_info);
   if (rv != 0) {
     return rv;
   }
 
-  prv_set_value_for_key(key, new_value, &value_info);
+  prv_set_value_for_key(instance, key, new_value, &value_info);
 
   return 0;
 }
@@ -564,7 +1190,7 @@ int memfault_metrics_heartbeat_set_signed(MemfaultMetricId key, int32_t signed_v
   int rv;
   memfault_lock();
   {
-    rv = prv_find_and_set_value_for_key(key, kMemfaultMetricType_Signed,
+    rv = prv_find_and_set_value_for_key(NULL, key, kMemfaultMetricType_Signed,
                                         &(union MemfaultMetricValue){ .i32 = signed_value });
   }
   memfault_unlock();
@@ -575,39 +1201,277 @@ int memfault_metrics_heartbeat_set_unsigned(MemfaultMetricId key, uint32_t unsig
   int rv;
   memfault_lock();
   {
-    rv = prv_find_and_set_value_for_key(key, kMemfaultMetricType_Unsigned,
+    rv = prv_find_and_set_value_for_key(NULL, key, kMemfaultMetricType_Unsigned,
                                         &(union MemfaultMetricValue){ .u32 = unsigned_value });
   }
   memfault_unlock();
   return rv;
 }
 
-int memfault_metrics_heartbeat_set_string(MemfaultMetricId key, const char *value) {
+static int prv_find_and_set_value64_for_key(const sMfltMetricsSessionInstance *instance,
+                                            MemfaultMetricId key, eMemfaultMetricType expected_type,
+                                            uint64_t new_value) {
+  sMemfaultMetricValueInfo value_info = { 0 };
+  int rv = prv_find_value_info_for_type(instance, key, expected_type, &value_info);
+  if (rv != 0) {
+    return rv;
+  }
+
+  prv_value64_write(value_info.valuep->ptr, new_value);
+  prv_read_write_is_value_set(instance, key, true);
+
+  return 0;
+}
+
+int memfault_metrics_heartbeat_set_signed64(MemfaultMetricId key, int64_t signed_value) {
   int rv;
   memfault_lock();
   {
-    sMemfaultMetricValueInfo value_info = { 0 };
-    rv = prv_find_value_info_for_type(key, kMemfaultMetricType_String, &value_info);
-    const sMemfaultMetricKVPair *kv = prv_find_kvpair_for_key(key);
-
-    // error if either the key is bad, or we can't find the kvpair for the key
-    // (both checks should have the same result though)
-    rv = (rv != 0 || kv == NULL) ? MEMFAULT_METRICS_KEY_NOT_FOUND : 0;
+    rv = prv_find_and_set_value64_for_key(NULL, key, kMemfaultMetricType_Signed64,
+                                          (uint64_t)signed_value);
+  }
+  memfault_unlock();
+  return rv;
+}
 
-    if (rv == 0) {
-      const size_t len = MEMFAULT_MIN(strlen(value), kv->range);
-      memcpy(value_info.valuep->ptr, value, len);
-      // null terminate
-      ((char *)value_info.valuep->ptr)[len] = '\0';
-    }
+int memfault_metrics_heartbeat_set_unsigned64(MemfaultMetricId key, uint64_t unsigned_value) {
+  int rv;
+  memfault_lock();
+  {
+    rv = prv_find_and_set_value64_for_key(NULL, key, kMemfaultMetricType_Unsigned64,
+                                          unsigned_value);
   }
   memfault_unlock();
   return rv;
 }
 
-typedef enum {
-  kMemfaultTimerOp_Start,
-  kMemfaultTimerOp_Stop,
+static int prv_set_string_nolock(const sMfltMetricsSessionInstance *instance,
+                                 MemfaultMetricId key, const char *value) {
+  sMemfaultMetricValueInfo value_info = { 0 };
+  int rv = prv_find_value_info_for_type(instance, key, kMemfaultMetricType_String, &value_info);
+  const sMemfaultMetricKVPair *kv = prv_find_kvpair_for_key(key);
+
+  // error if either the key is bad, or we can't find the kvpair for the key
+  // (both checks should have the same result though)
+  rv = (rv != 0 || kv == NULL) ? MEMFAULT_METRICS_KEY_NOT_FOUND : 0;
+
+  if (rv == 0) {
+    const size_t len = MEMFAULT_MIN(strlen(value), kv->range);
+    memcpy(value_info.valuep->ptr, value, len);
+    // null terminate
+    ((char *)value_info.valuep->ptr)[len] = '\0';
+  }
+  return rv;
+}
+
+int memfault_metrics_heartbeat_set_string(MemfaultMetricId key, const char *value) {
+  int rv;
+  memfault_lock();
+  { rv = prv_set_string_nolock(NULL, key, value); }
+  memfault_unlock();
+  return rv;
+}
+
+static void prv_histogram_record(sMemfaultMetricHistogram *histogram, uint32_t value) {
+  if (histogram->count == 0) {
+    histogram->min = value;
+    histogram->max = value;
+  } else {
+    histogram->min = MEMFAULT_MIN(histogram->min, value);
+    histogram->max = MEMFAULT_MAX(histogram->max, value);
+  }
+
+  // Clip in case of overflow. The sum can only overflow after 2^32 samples of UINT32_MAX, so the
+  // count saturating first keeps the sum accurate for every sample counted
+  if (histogram->count != UINT32_MAX) {
+    histogram->count++;
+    histogram->sum += value;
+  }
+
+  // Bucket 0 holds 0 and bucket n holds [2^(n-1), 2^n), i.e the bit length of the value
+  const uint32_t bit_length = 32 - MEMFAULT_CLZ(value);
+  const size_t bucket = MEMFAULT_MIN(bit_length, MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS - 1);
+  if (histogram->buckets[bucket] == UINT16_MAX) {
+    // Halve every bucket rather than saturating one so the shape of the distribution, and the
+    // percentiles derived from it, are preserved. Non-empty buckets are kept non-empty.
+    for (size_t i = 0; i < MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS; i++) {
+      histogram->buckets[i] = (uint16_t)((histogram->buckets[i] + 1u) / 2u);
+    }
+  }
+  histogram->buckets[bucket]++;
+}
+
+static int prv_record_nolock(const sMfltMetricsSessionInstance *instance, MemfaultMetricId key,
+                             uint32_t value) {
+  sMemfaultMetricValueInfo value_info = { 0 };
+  const int rv =
+    prv_find_value_info_for_type(instance, key, kMemfaultMetricType_Histogram, &value_info);
+  if (rv == 0) {
+    prv_histogram_record(value_info.valuep->ptr, value);
+  }
+  return rv;
+}
+
+int memfault_metrics_heartbeat_record(MemfaultMetricId key, uint32_t value) {
+  int rv;
+  memfault_lock();
+  { rv = prv_record_nolock(NULL, key, value); }
+  memfault_unlock();
+  return rv;
+}
+
+uint32_t memfault_metrics_histogram_percentile(const sMemfaultMetricHistogram *histogram,
+                                               uint32_t percentile) {
+  if ((histogram == NULL) || (histogram->count == 0)) {
+    return 0;
+  }
+
+  // Bucket counts are rescaled independently of the total count, so rank against the bucket total
+  uint32_t total = 0;
+  for (size_t i = 0; i < MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS; i++) {
+    total += histogram->buckets[i];
+  }
+  const uint64_t rank =
+    MEMFAULT_MAX(((uint64_t)total * MEMFAULT_MIN(percentile, 100) + 99) / 100, 1);
+
+  uint32_t seen = 0;
+  size_t bucket = 0;
+  for (; bucket < MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS - 1; bucket++) {
+    seen += histogram->buckets[bucket];
+    if (seen >= rank) {
+      break;
+    }
+  }
+
+  // The last bucket is unbounded, every other one tops out at 2^bucket - 1
+  const uint32_t upper_bound = (bucket == MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS - 1) ?
+                                 histogram->max :
+                                 (uint32_t)((1ULL << bucket) - 1);
+  return MEMFAULT_MAX(MEMFAULT_MIN(upper_bound, histogram->max), histogram->min);
+}
+
+MEMFAULT_STATIC_ASSERT(MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES >= 8 &&
+                         MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES <= UINT16_MAX,
+                       "MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES must be between 8 and 65535");
+
+// Downsampling stops halving the resolution here so the bucket size can't overflow
+#define MEMFAULT_METRICS_TIME_SERIES_MAX_LEVEL 30
+
+static void prv_time_series_reset(sMemfaultMetricTimeSeries *time_series) {
+  time_series->start_ms = memfault_platform_get_time_since_boot_ms();
+  time_series->num_samples = 0;
+  time_series->level = 0;
+  time_series->bucket_count = 0;
+}
+
+size_t memfault_metrics_time_series_pending_samples(const sMemfaultMetricTimeSeries *time_series,
+                                                    sMemfaultMetricTimeSeriesSample out[2]) {
+  if (time_series->bucket_count == 0) {
+    return 0;
+  }
+
+  const sMemfaultMetricTimeSeriesSample *min = &time_series->bucket_min;
+  const sMemfaultMetricTimeSeriesSample *max = &time_series->bucket_max;
+  if ((min->offset_ms == max->offset_ms) && (min->value == max->value)) {
+    out[0] = *min;
+    return 1;
+  }
+
+  const bool min_first = min->offset_ms <= max->offset_ms;
+  out[0] = min_first ? *min : *max;
+  out[1] = min_first ? *max : *min;
+  return 2;
+}
+
+//! Replace every group of 4 samples by its min and max, in the order they were recorded
+static void prv_time_series_downsample(sMemfaultMetricTimeSeries *time_series) {
+  sMemfaultMetricTimeSeriesSample *samples = time_series->samples;
+  size_t num_out = 0;
+  for (size_t i = 0; i < time_series->num_samples; i += 4) {
+    const size_t end = MEMFAULT_MIN(i + 4, (size_t)time_series->num_samples);
+    size_t min_idx = i;
+    size_t max_idx = i;
+    for (size_t j = i + 1; j < end; j++) {
+      if (samples[j].value < samples[min_idx].value) {
+        min_idx = j;
+      }
+      if (samples[j].value > samples[max_idx].value) {
+        max_idx = j;
+      }
+    }
+
+    // both reads happen before either write, num_out never passes i
+    const sMemfaultMetricTimeSeriesSample first = samples[MEMFAULT_MIN(min_idx, max_idx)];
+    const sMemfaultMetricTimeSeriesSample second = samples[MEMFAULT_MAX(min_idx, max_idx)];
+    samples[num_out++] = first;
+    if (min_idx != max_idx) {
+      samples[num_out++] = second;
+    }
+  }
+
+  time_series->num_samples = (uint16_t)num_out;
+  if (time_series->level < MEMFAULT_METRICS_TIME_SERIES_MAX_LEVEL) {
+    time_series->level++;
+  }
+}
+
+static void prv_time_series_record(sMemfaultMetricTimeSeries *time_series, int32_t value) {
+  const uint64_t offset_ms = memfault_platform_get_time_since_boot_ms() - time_series->start_ms;
+  const sMemfaultMetricTimeSeriesSample sample = {
+    .offset_ms = (uint32_t)MEMFAULT_MIN(offset_ms, UINT32_MAX),
+    .value = value,
+  };
+
+  if (time_series->bucket_count == 0) {
+    time_series->bucket_min = sample;
+    time_series->bucket_max = sample;
+  } else if (value < time_series->bucket_min.value) {
+    time_series->bucket_min = sample;
+  } else if (value > time_series->bucket_max.value) {
+    time_series->bucket_max = sample;
+  }
+  time_series->bucket_count++;
+
+  // At level 0 every sample is kept. Each downsampling merges 4 samples into 2, so at level N a
+  // bucket spans 2^(N+1) recorded samples, matching the resolution of the samples kept so far.
+  const uint32_t bucket_size = (time_series->level == 0) ? 1 : (2u << time_series->level);
+  if (time_series->bucket_count < bucket_size) {
+    return;
+  }
+
+  sMemfaultMetricTimeSeriesSample pending[2];
+  const size_t num_pending = memfault_metrics_time_series_pending_samples(time_series, pending);
+  if (time_series->num_samples + num_pending > MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES) {
+    prv_time_series_downsample(time_series);
+  }
+  for (size_t i = 0; i < num_pending; i++) {
+    time_series->samples[time_series->num_samples++] = pending[i];
+  }
+  time_series->bucket_count = 0;
+}
+
+static int prv_sample_nolock(const sMfltMetricsSessionInstance *instance, MemfaultMetricId key,
+                             int32_t value) {
+  sMemfaultMetricValueInfo value_info = { 0 };
+  const int rv =
+    prv_find_value_info_for_type(instance, key, kMemfaultMetricType_TimeSeries, &value_info);
+  if (rv == 0) {
+    prv_time_series_record(value_info.valuep->ptr, value);
+  }
+  return rv;
+}
+
+int memfault_metrics_heartbeat_sample(MemfaultMetricId key, int32_t value) {
+  int rv;
+  memfault_lock();
+  { rv = prv_sample_nolock(NULL, key, value); }
+  memfault_unlock();
+  return rv;
+}
+
+typedef enum {
+  kMemfaultTimerOp_Start,
+  kMemfaultTimerOp_Stop,
   kMemfaultTimerOp_ForceValueUpdate,
 } eMemfaultTimerOp;
 
@@ -658,24 +1522,63 @@ static bool prv_update_timer_metric(const sMemfaultMetricValueInfo *value_info,
   return false;
 }
 
-static int prv_find_timer_metric_and_update(MemfaultMetricId key, eMemfaultTimerOp op) {
+static bool prv_update_high_res_timer_metric(sMemfaultMetricHighResTimer *timer,
+                                             eMemfaultTimerOp op) {
+  // The timer is not running _and_ we received a Start request
+  if (!timer->is_running && op == kMemfaultTimerOp_Start) {
+    timer->start_ticks = memfault_platform_metrics_high_res_timer_read();
+    timer->is_running = true;
+    return true;
+  }
+
+  // the timer is running and we received a Stop or ForceValueUpdate request
+  if (timer->is_running && op != kMemfaultTimerOp_Start) {
+    const uint64_t stop_ticks = memfault_platform_metrics_high_res_timer_read();
+    // unsigned subtraction modulo the counter width accounts for a counter rollover
+    timer->total_ticks += (stop_ticks - timer->start_ticks) & MEMFAULT_METRICS_HIGH_RES_TIMER_MASK;
+
+    if (op == kMemfaultTimerOp_Stop) {
+      timer->start_ticks = 0;
+      timer->is_running = false;
+    } else {
+      timer->start_ticks = stop_ticks;
+    }
+
+    return true;
+  }
+
+  // We were already in the state requested and no update took place
+  return false;
+}
+
+static int prv_find_timer_metric_and_update(const sMfltMetricsSessionInstance *instance,
+                                            MemfaultMetricId key, eMemfaultTimerOp op) {
   sMemfaultMetricValueInfo value_info = { 0 };
-  int rv = prv_find_value_info_for_type(key, kMemfaultMetricType_Timer, &value_info);
-  if (rv != 0) {
-    return rv;
+  const eMemfaultMetricType type = prv_find_value_for_key(instance, key, &value_info);
+  if (value_info.valuep == NULL) {
+    return MEMFAULT_METRICS_KEY_NOT_FOUND;
   }
 
   // If the value did not change because the timer was already in the state requested return an
   // error code. This will make it easier for users of the external API to catch if their calls
   // were unbalanced.
-  const bool did_update = prv_update_timer_metric(&value_info, op);
+  bool did_update;
+  if (type == kMemfaultMetricType_Timer) {
+    did_update = prv_update_timer_metric(&value_info, op);
+  } else if (type == kMemfaultMetricType_HighResTimer) {
+    did_update = prv_update_high_res_timer_metric(value_info.valuep->ptr, op);
+  } else {
+    MEMFAULT_LOG_ERROR("Invalid type (%u vs %u) for key: %d", kMemfaultMetricType_Timer, type,
+                       key._impl);
+    return MEMFAULT_METRICS_TYPE_INCOMPATIBLE;
+  }
   return did_update ? 0 : MEMFAULT_METRICS_TYPE_NO_CHANGE;
 }
 
 int memfault_metrics_heartbeat_timer_start(MemfaultMetricId key) {
   int rv;
   memfault_lock();
-  { rv = prv_find_timer_metric_and_update(key, kMemfaultTimerOp_Start); }
+  { rv = prv_find_timer_metric_and_update(NULL, key, kMemfaultTimerOp_Start); }
   memfault_unlock();
   return rv;
 }
@@ -683,7 +1586,7 @@ int memfault_metrics_heartbeat_timer_start(MemfaultMetricId key) {
 int memfault_metrics_heartbeat_timer_stop(MemfaultMetricId key) {
   int rv;
   memfault_lock();
-  { rv = prv_find_timer_metric_and_update(key, kMemfaultTimerOp_Stop); }
+  { rv = prv_find_timer_metric_and_update(NULL, key, kMemfaultTimerOp_Stop); }
   memfault_unlock();
   return rv;
 }
@@ -691,20 +1594,21 @@ int memfault_metrics_heartbeat_timer_stop(MemfaultMetricId key) {
 static bool prv_tally_and_update_timer_cb(MEMFAULT_UNUSED void *ctx,
                                           const sMemfaultMetricKVPair *key,
                                           const sMemfaultMetricValueInfo *value) {
-  if (key->type != kMemfaultMetricType_Timer) {
-    return true;
+  if (key->type == kMemfaultMetricType_Timer) {
+    prv_update_timer_metric(value, kMemfaultTimerOp_ForceValueUpdate);
+  } else if (key->type == kMemfaultMetricType_HighResTimer) {
+    prv_update_high_res_timer_metric(value->valuep->ptr, kMemfaultTimerOp_ForceValueUpdate);
   }
-
-  prv_update_timer_metric(value, kMemfaultTimerOp_ForceValueUpdate);
   return true;
 }
 
 static void prv_reset_metrics(bool full_reset, eMfltMetricsSessionIndex session_key) {
   if (full_reset) {
     // if a full reset is indicated zero out all metrics regardless of session.
-    memset(s_memfault_heartbeat_values, 0, sizeof(s_memfault_heartbeat_values));
-    memset(s_memfault_heatbeat_value_is_set_flags, 0,
-           sizeof(s_memfault_heatbeat_value_is_set_flags));
+    memset(g_memfault_heartbeat_values, 0, sizeof(g_memfault_heartbeat_values));
+    memset(g_memfault_heartbeat_values64, 0, sizeof(g_memfault_heartbeat_values64));
+    memset(g_memfault_heartbeat_value_is_set_flags, 0,
+           sizeof(g_memfault_heartbeat_value_is_set_flags));
 
     // reset all string metric values. -1 to skip the last, stub entry in the
     // table
@@ -714,30 +1618,79 @@ static void prv_reset_metrics(bool full_reset, eMfltMetricsSessionIndex session_
         ((char *)s_memfault_heartbeat_string_values[i].ptr)[0] = 0;
       }
     }
+
+    for (size_t i = 0; i < MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_histogram_values); i++) {
+      if (s_memfault_heartbeat_histogram_values[i].ptr) {
+        memset(s_memfault_heartbeat_histogram_values[i].ptr, 0, sizeof(sMemfaultMetricHistogram));
+      }
+    }
+
+    // like timers, a running high resolution timer keeps running across the reset
+    for (size_t i = 0; i < MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_high_res_timer_values); i++) {
+      sMemfaultMetricHighResTimer *timer = s_memfault_heartbeat_high_res_timer_values[i].ptr;
+      if (timer) {
+        timer->total_ticks = 0;
+      }
+    }
+
+    for (size_t i = 0; i < MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_time_series_values); i++) {
+      if (s_memfault_heartbeat_time_series_values[i].ptr) {
+        prv_time_series_reset(s_memfault_heartbeat_time_series_values[i].ptr);
+      }
+    }
   } else {
     // otherwise only clear metrics from the specified session
-    for (uint32_t idx = 0; idx < MEMFAULT_ARRAY_SIZE(s_memfault_heartbeat_keys); ++idx) {
+    prv_session_keys_init();
+    const uint16_t *offsets = s_memfault_metrics_session_keys.offsets;
+    for (size_t i = offsets[session_key]; i < offsets[session_key + 1]; ++i) {
+      const size_t idx = s_memfault_metrics_session_keys.key_indices[i];
       const sMemfaultMetricKVPair *const kv_pair = &s_memfault_heartbeat_keys[idx];
-      // Skip all metrics from a different session
-      if (kv_pair->session_key != session_key) {
-        continue;
-      }
 
       eMfltMetricStringKeyToIndex string_idx = s_memfault_heartbeat_string_key_to_index[idx];
+      eMfltMetricHistogramKeyToIndex histogram_idx =
+        s_memfault_heartbeat_histogram_key_to_index[idx];
+      eMfltMetricHighResTimerKeyToIndex high_res_timer_idx =
+        s_memfault_heartbeat_high_res_timer_key_to_index[idx];
+      eMfltMetricValue64Index value64_idx = s_memfault_heartbeat_value64_key_to_index[idx];
+      eMfltMetricTimeSeriesKeyToIndex time_series_idx =
+        s_memfault_heartbeat_time_series_key_to_index[idx];
       eMfltMetricKeyToValueIndex key_index = MEMFAULT_METRICS_KEY_TO_KV_INDEX(idx);
       switch (kv_pair->type) {
         case kMemfaultMetricType_Timer:
         case kMemfaultMetricType_Signed:
         case kMemfaultMetricType_Unsigned: {
-          s_memfault_heartbeat_values[key_index] = (union MemfaultMetricValue){ 0 };
+          g_memfault_heartbeat_values[key_index] = (union MemfaultMetricValue){ 0 };
           prv_clear_is_value_set(key_index);
           break;
         }
+        case kMemfaultMetricType_Unsigned64:
+        case kMemfaultMetricType_Signed64:
+          g_memfault_heartbeat_values64[value64_idx] = (sMemfaultMetricValue64){ 0 };
+          prv_clear_is_value_set(key_index);
+          break;
         case kMemfaultMetricType_String:
           if (s_memfault_heartbeat_string_values[string_idx].ptr) {
             ((char *)s_memfault_heartbeat_string_values[string_idx].ptr)[0] = 0;
           }
           break;
+        case kMemfaultMetricType_Histogram:
+          if (s_memfault_heartbeat_histogram_values[histogram_idx].ptr) {
+            memset(s_memfault_heartbeat_histogram_values[histogram_idx].ptr, 0,
+                   sizeof(sMemfaultMetricHistogram));
+          }
+          break;
+        case kMemfaultMetricType_HighResTimer: {
+          sMemfaultMetricHighResTimer *timer =
+            s_memfault_heartbeat_high_res_timer_values[high_res_timer_idx].ptr;
+          if (timer) {
+            timer->total_ticks = 0;
+          }
+        } break;
+        case kMemfaultMetricType_TimeSeries:
+          if (s_memfault_heartbeat_time_series_values[time_series_idx].ptr) {
+            prv_time_series_reset(s_memfault_heartbeat_time_series_values[time_series_idx].ptr);
+          }
+          break;
         case kMemfaultMetricType_NumTypes:  // To silence -Wswitch-enum
         default:
           break;
@@ -746,6 +1699,136 @@ static void prv_reset_metrics(bool full_reset, eMfltMetricsSessionIndex session_
   }
 }
 
+#if MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+//! Copy the current values of a session's metrics into s_memfault_metrics_snapshot. Must be
+//! called with memfault_lock() held.
+//!
+//! @return false if the snapshot is still being serialized from. Event storage only accepts one
+//! event at a time, so the caller has to retry later instead of serializing the live values.
+static bool prv_snapshot_take(eMfltMetricsSessionIndex session_key) {
+  if (s_memfault_metrics_snapshot.in_use) {
+    return false;
+  }
+
+  prv_session_keys_init();
+  const uint16_t *offsets = s_memfault_metrics_session_keys.offsets;
+  char *string_dst = s_memfault_metrics_snapshot.strings;
+  size_t num_histograms = 0;
+  size_t num_high_res_timers = 0;
+  size_t num_values64 = 0;
+  size_t num_time_series = 0;
+  memset(s_memfault_metrics_snapshot.is_set_flags, 0,
+         sizeof(s_memfault_metrics_snapshot.is_set_flags));
+
+  for (size_t i = offsets[session_key]; i < offsets[session_key + 1]; ++i) {
+    const size_t pos = i - offsets[session_key];
+    const sMemfaultMetricKVPair *const kv_pair =
+      &s_memfault_heartbeat_keys[s_memfault_metrics_session_keys.key_indices[i]];
+    sMemfaultMetricValueInfo value_info = { 0 };
+    const eMemfaultMetricType type = prv_find_value_for_key(NULL, kv_pair->key, &value_info);
+    union MemfaultMetricValue value = *value_info.valuep;
+
+    switch (type) {
+      case kMemfaultMetricType_String: {
+        const size_t len = MEMFAULT_MIN(strlen(value.ptr), kv_pair->range);
+        memcpy(string_dst, value.ptr, len);
+        string_dst[len] = '\0';
+        value.ptr = string_dst;
+        string_dst += len + 1;
+      } break;
+      case kMemfaultMetricType_Histogram: {
+        sMemfaultMetricHistogram *histogram =
+          &s_memfault_metrics_snapshot.histograms[num_histograms++];
+        *histogram = *(const sMemfaultMetricHistogram *)value.ptr;
+        value.ptr = histogram;
+      } break;
+      case kMemfaultMetricType_HighResTimer: {
+        sMemfaultMetricHighResTimer *timer =
+          &s_memfault_metrics_snapshot.high_res_timers[num_high_res_timers++];
+        *timer = *(const sMemfaultMetricHighResTimer *)value.ptr;
+        value.ptr = timer;
+      } break;
+      case kMemfaultMetricType_Unsigned64:
+      case kMemfaultMetricType_Signed64: {
+        sMemfaultMetricValue64 *value64 = &s_memfault_metrics_snapshot.values64[num_values64++];
+        *value64 = *(const sMemfaultMetricValue64 *)value.ptr;
+        value.ptr = value64;
+      } break;
+      case kMemfaultMetricType_TimeSeries: {
+        sMemfaultMetricTimeSeries *time_series =
+          &s_memfault_metrics_snapshot.time_series[num_time_series++];
+        *time_series = *(const sMemfaultMetricTimeSeries *)value.ptr;
+        value.ptr = time_series;
+      } break;
+      case kMemfaultMetricType_Timer:
+      case kMemfaultMetricType_Signed:
+      case kMemfaultMetricType_Unsigned:
+      case kMemfaultMetricType_NumTypes:  // To silence -Wswitch-enum
+      default:
+        break;
+    }
+
+    s_memfault_metrics_snapshot.values[pos] = value;
+    if (value_info.is_set) {
+      s_memfault_metrics_snapshot.is_set_flags[pos >> MEMFAULT_IS_SET_FLAGS_DIVIDER] |=
+        (1 << (pos % MEMFAULT_IS_SET_FLAGS_PER_BYTE));
+    }
+  }
+
+  s_memfault_metrics_snapshot.session_key = session_key;
+  s_memfault_metrics_snapshot.in_use = true;
+  return true;
+}
+
+static void prv_heartbeat_timer_update(void);
+
+//! Free up the snapshot, or take it again for a session which ended while it was in use. A
+//! pending heartbeat is reset once taken, like on its tick.
+//!
+//! @return true if the snapshot was taken again and needs to be serialized
+static bool prv_snapshot_release(void) {
+  bool retaken = false;
+  memfault_lock();
+  {
+    s_memfault_metrics_snapshot.in_use = false;
+    for (size_t i = 0; (i < MEMFAULT_ARRAY_SIZE(s_memfault_metrics_snapshot.end_pending)) &&
+                       !retaken;
+         i++) {
+      if (s_memfault_metrics_snapshot.end_pending[i]) {
+        s_memfault_metrics_snapshot.end_pending[i] = false;
+        const bool is_heartbeat = (i == MEMFAULT_METRICS_SESSION_KEY(heartbeat));
+        if (is_heartbeat) {
+          prv_heartbeat_timer_update();
+        }
+        retaken = prv_snapshot_take((eMfltMetricsSessionIndex)i);
+        if (retaken && is_heartbeat) {
+          prv_reset_metrics(false, MEMFAULT_METRICS_SESSION_KEY(heartbeat));
+        }
+      }
+    }
+  }
+  memfault_unlock();
+  return retaken;
+}
+
+//! Serialize the snapshot taken by prv_snapshot_take(), then any session ends which were waiting
+//! on it, and free it up for the next one. Called without memfault_lock() held; event storage
+//! only takes the lock for each of its writes.
+//!
+//! @return the result of serializing the snapshot the caller took
+static bool prv_snapshot_serialize_and_release(void) {
+  const bool success = memfault_metrics_session_serialize_snapshot(
+    s_memfault_metrics_ctx.storage_impl, s_memfault_metrics_snapshot.session_key);
+
+  while (prv_snapshot_release()) {
+    (void)memfault_metrics_session_serialize_snapshot(s_memfault_metrics_ctx.storage_impl,
+                                                      s_memfault_metrics_snapshot.session_key);
+  }
+
+  return success;
+}
+#endif
+
 static void prv_heartbeat_timer_update(void) {
   // force an update of the timer value for any actively running timers
   prv_metric_iterator(NULL, prv_tally_and_update_timer_cb);
@@ -758,14 +1841,34 @@ static void prv_heartbeat_timer(void) {
   prv_collect_builtin_data();
   memfault_metrics_heartbeat_collect_data();
 
+#if MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+  // Snapshot and reset in one critical section, so values recorded while the snapshot is being
+  // serialized count towards the next heartbeat instead of being dropped by the reset
+  memfault_lock();
+  const bool from_snapshot = prv_snapshot_take(MEMFAULT_METRICS_SESSION_KEY(heartbeat));
+  if (from_snapshot) {
+    prv_reset_metrics(false, MEMFAULT_METRICS_SESSION_KEY(heartbeat));
+  }
+  // Otherwise the snapshot is still being serialized and storage can't take another event. Its
+  // owner takes the heartbeat next, before releasing it, so the interval still ends about now.
+  s_memfault_metrics_snapshot.end_pending[MEMFAULT_METRICS_SESSION_KEY(heartbeat)] =
+    !from_snapshot;
+  memfault_unlock();
+
+  if (from_snapshot) {
+    (void)prv_snapshot_serialize_and_release();
+  }
+#else
   memfault_metrics_heartbeat_serialize(s_memfault_metrics_ctx.storage_impl);
 
   prv_reset_metrics(false, MEMFAULT_METRICS_SESSION_KEY(heartbeat));
+#endif
 }
 
-static int prv_find_key_and_add(MemfaultMetricId key, int32_t amount) {
+static int prv_find_key_and_add(const sMfltMetricsSessionInstance *instance, MemfaultMetricId key,
+                                int32_t amount) {
   sMemfaultMetricValueInfo value_info = { 0 };
-  const eMemfaultMetricType type = prv_find_value_for_key(key, &value_info);
+  const eMemfaultMetricType type = prv_find_value_for_key(instance, key, &value_info);
   if (value_info.valuep == NULL) {
     return MEMFAULT_METRICS_KEY_NOT_FOUND;
   }
@@ -797,8 +1900,39 @@ static int prv_find_key_and_add(MemfaultMetricId key, int32_t amount) {
       break;
     }
 
+    case kMemfaultMetricType_Signed64: {
+      const int64_t current = (int64_t)prv_value64_read(value->ptr);
+      int64_t new_value;
+      // Clip in case of overflow:
+      if ((amount > 0) && (current > INT64_MAX - amount)) {
+        new_value = INT64_MAX;
+      } else if ((amount < 0) && (current < INT64_MIN - amount)) {
+        new_value = INT64_MIN;
+      } else {
+        new_value = current + amount;
+      }
+      prv_value64_write(value->ptr, (uint64_t)new_value);
+      break;
+    }
+
+    case kMemfaultMetricType_Unsigned64: {
+      const uint64_t current = prv_value64_read(value->ptr);
+      uint64_t new_value;
+      // Clip in case of overflow:
+      if (amount >= 0) {
+        new_value = current + (uint64_t)amount;
+        new_value = (new_value < current) ? UINT64_MAX : new_value;
+      } else {
+        const uint64_t decrement = (uint64_t)(-(int64_t)amount);
+        new_value = (current > decrement) ? (current - decrement) : 0;
+      }
+      prv_value64_write(value->ptr, new_value);
+      break;
+    }
+
     case kMemfaultMetricType_Timer:
     case kMemfaultMetricType_String:
+    case kMemfaultMetricType_Histogram:
     case kMemfaultMetricType_NumTypes:  // To silence -Wswitch-enum
     default:
       // To easily get name of metric in gdb, p/s (eMfltMetricsIndex)0
@@ -808,30 +1942,36 @@ static int prv_find_key_and_add(MemfaultMetricId key, int32_t amount) {
   return 0;
 }
 
+static int prv_add_nolock(const sMfltMetricsSessionInstance *instance, MemfaultMetricId key,
+                          int32_t amount) {
+  const int rv = prv_find_key_and_add(instance, key, amount);
+  if (rv == 0) {
+    prv_read_write_is_value_set(instance, key, true);
+  }
+  return rv;
+}
+
 int memfault_metrics_heartbeat_add(MemfaultMetricId key, int32_t amount) {
   int rv;
   memfault_lock();
-  {
-    rv = prv_find_key_and_add(key, amount);
-    if (rv == 0) {
-      prv_read_write_is_value_set(key, true);
-    }
-  }
+  { rv = prv_add_nolock(NULL, key, amount); }
   memfault_unlock();
   return rv;
 }
 
-static int prv_find_key_of_type(MemfaultMetricId key, eMemfaultMetricType expected_type,
+static int prv_find_key_of_type(const sMfltMetricsSessionInstance *instance, MemfaultMetricId key,
+                                eMemfaultMetricType expected_type,
                                 union MemfaultMetricValue **value_out) {
   sMemfaultMetricValueInfo value_info = { 0 };
-  const eMemfaultMetricType type = prv_find_value_for_key(key, &value_info);
+  const eMemfaultMetricType type = prv_find_value_for_key(instance, key, &value_info);
   if (value_info.valuep == NULL) {
     return MEMFAULT_METRICS_KEY_NOT_FOUND;
   }
   if (type != expected_type) {
     return MEMFAULT_METRICS_TYPE_INCOMPATIBLE;
   }
-  if ((type == kMemfaultMetricType_Signed || type == kMemfaultMetricType_Unsigned) &&
+  if ((type == kMemfaultMetricType_Signed || type == kMemfaultMetricType_Unsigned ||
+       type == kMemfaultMetricType_Signed64 || type == kMemfaultMetricType_Unsigned64) &&
       !(value_info.is_set)) {
     return MEMFAULT_METRICS_VALUE_NOT_SET;
   }
@@ -840,7 +1980,51 @@ static int prv_find_key_of_type(MemfaultMetricId key, eMemfaultMetricType expect
   return 0;
 }
 
+static int prv_read_unsigned_nolock(const sMfltMetricsSessionInstance *instance,
+                                    MemfaultMetricId key, uint32_t *read_val) {
+  if (read_val == NULL) {
+    return MEMFAULT_METRICS_TYPE_BAD_PARAM;
+  }
+
+  union MemfaultMetricValue *value;
+  const int rv = prv_find_key_of_type(instance, key, kMemfaultMetricType_Unsigned, &value);
+  if (rv == 0) {
+    *read_val = value->u32;
+  }
+  return rv;
+}
+
 int memfault_metrics_heartbeat_read_unsigned(MemfaultMetricId key, uint32_t *read_val) {
+  int rv;
+  memfault_lock();
+  { rv = prv_read_unsigned_nolock(NULL, key, read_val); }
+  memfault_unlock();
+  return rv;
+}
+
+static int prv_read_signed_nolock(const sMfltMetricsSessionInstance *instance,
+                                  MemfaultMetricId key, int32_t *read_val) {
+  if (read_val == NULL) {
+    return MEMFAULT_METRICS_TYPE_BAD_PARAM;
+  }
+
+  union MemfaultMetricValue *value;
+  const int rv = prv_find_key_of_type(instance, key, kMemfaultMetricType_Signed, &value);
+  if (rv == 0) {
+    *read_val = value->i32;
+  }
+  return rv;
+}
+
+int memfault_metrics_heartbeat_read_signed(MemfaultMetricId key, int32_t *read_val) {
+  int rv;
+  memfault_lock();
+  { rv = prv_read_signed_nolock(NULL, key, read_val); }
+  memfault_unlock();
+  return rv;
+}
+
+int memfault_metrics_heartbeat_read_unsigned64(MemfaultMetricId key, uint64_t *read_val) {
   if (read_val == NULL) {
     return MEMFAULT_METRICS_TYPE_BAD_PARAM;
   }
@@ -849,16 +2033,16 @@ int memfault_metrics_heartbeat_read_unsigned(MemfaultMetricId key, uint32_t *rea
   memfault_lock();
   {
     union MemfaultMetricValue *value;
-    rv = prv_find_key_of_type(key, kMemfaultMetricType_Unsigned, &value);
+    rv = prv_find_key_of_type(NULL, key, kMemfaultMetricType_Unsigned64, &value);
     if (rv == 0) {
-      *read_val = value->u32;
+      *read_val = prv_value64_read(value->ptr);
     }
   }
   memfault_unlock();
   return rv;
 }
 
-int memfault_metrics_heartbeat_read_signed(MemfaultMetricId key, int32_t *read_val) {
+int memfault_metrics_heartbeat_read_signed64(MemfaultMetricId key, int64_t *read_val) {
   if (read_val == NULL) {
     return MEMFAULT_METRICS_TYPE_BAD_PARAM;
   }
@@ -867,33 +2051,57 @@ int memfault_metrics_heartbeat_read_signed(MemfaultMetricId key, int32_t *read_v
   memfault_lock();
   {
     union MemfaultMetricValue *value;
-    rv = prv_find_key_of_type(key, kMemfaultMetricType_Signed, &value);
+    rv = prv_find_key_of_type(NULL, key, kMemfaultMetricType_Signed64, &value);
     if (rv == 0) {
-      *read_val = value->i32;
+      *read_val = (int64_t)prv_value64_read(value->ptr);
     }
   }
   memfault_unlock();
   return rv;
 }
 
-int memfault_metrics_heartbeat_timer_read(MemfaultMetricId key, uint32_t *read_val) {
+static int prv_timer_read_nolock(const sMfltMetricsSessionInstance *instance, MemfaultMetricId key,
+                                 uint32_t *read_val) {
   if (read_val == NULL) {
     return MEMFAULT_METRICS_TYPE_BAD_PARAM;
   }
 
+  union MemfaultMetricValue *value;
+  prv_find_timer_metric_and_update(instance, key, kMemfaultTimerOp_ForceValueUpdate);
+  const int rv = prv_find_key_of_type(instance, key, kMemfaultMetricType_Timer, &value);
+  if (rv == 0) {
+    *read_val = value->u32;
+  }
+  return rv;
+}
+
+int memfault_metrics_heartbeat_timer_read(MemfaultMetricId key, uint32_t *read_val) {
+  int rv;
+  memfault_lock();
+  { rv = prv_timer_read_nolock(NULL, key, read_val); }
+  memfault_unlock();
+  return rv;
+}
+
+int memfault_metrics_heartbeat_high_res_timer_read(MemfaultMetricId key, uint64_t *read_ticks) {
+  if (read_ticks == NULL) {
+    return MEMFAULT_METRICS_TYPE_BAD_PARAM;
+  }
+
   int rv;
   memfault_lock();
   {
     union MemfaultMetricValue *value;
-    prv_find_timer_metric_and_update(key, kMemfaultTimerOp_ForceValueUpdate);
-    rv = prv_find_key_of_type(key, kMemfaultMetricType_Timer, &value);
+    prv_find_timer_metric_and_update(NULL, key, kMemfaultTimerOp_ForceValueUpdate);
+    rv = prv_find_key_of_type(NULL, key, kMemfaultMetricType_HighResTimer, &value);
     if (rv == 0) {
-      *read_val = value->u32;
+      *read_ticks = ((const sMemfaultMetricHighResTimer *)value->ptr)->total_ticks;
     }
   }
   memfault_unlock();
   return rv;
 }
+
 int memfault_metrics_heartbeat_read_string(MemfaultMetricId key, char *read_val,
                                            size_t read_val_len) {
   if ((read_val == NULL) || (read_val_len == 0)) {
@@ -904,7 +2112,7 @@ int memfault_metrics_heartbeat_read_string(MemfaultMetricId key, char *read_val,
   memfault_lock();
   {
     union MemfaultMetricValue *value;
-    rv = prv_find_key_of_type(key, kMemfaultMetricType_String, &value);
+    rv = prv_find_key_of_type(NULL, key, kMemfaultMetricType_String, &value);
     const sMemfaultMetricKVPair *kv = prv_find_kvpair_for_key(key);
 
     rv = (rv != 0 || kv == NULL) ? MEMFAULT_METRICS_KEY_NOT_FOUND : 0;
@@ -923,6 +2131,48 @@ int memfault_metrics_heartbeat_read_string(MemfaultMetricId key, char *read_val,
   return rv;
 }
 
+static int prv_read_histogram_nolock(const sMfltMetricsSessionInstance *instance,
+                                     MemfaultMetricId key, sMemfaultMetricHistogram *read_val) {
+  if (read_val == NULL) {
+    return MEMFAULT_METRICS_TYPE_BAD_PARAM;
+  }
+
+  union MemfaultMetricValue *value;
+  const int rv = prv_find_key_of_type(instance, key, kMemfaultMetricType_Histogram, &value);
+  if (rv == 0) {
+    *read_val = *(const sMemfaultMetricHistogram *)value->ptr;
+  }
+  return rv;
+}
+
+int memfault_metrics_heartbeat_read_histogram(MemfaultMetricId key,
+                                              sMemfaultMetricHistogram *read_val) {
+  int rv;
+  memfault_lock();
+  { rv = prv_read_histogram_nolock(NULL, key, read_val); }
+  memfault_unlock();
+  return rv;
+}
+
+int memfault_metrics_heartbeat_read_time_series(MemfaultMetricId key,
+                                                sMemfaultMetricTimeSeries *read_val) {
+  if (read_val == NULL) {
+    return MEMFAULT_METRICS_TYPE_BAD_PARAM;
+  }
+
+  int rv;
+  memfault_lock();
+  {
+    union MemfaultMetricValue *value;
+    rv = prv_find_key_of_type(NULL, key, kMemfaultMetricType_TimeSeries, &value);
+    if (rv == 0) {
+      *read_val = *(const sMemfaultMetricTimeSeries *)value->ptr;
+    }
+  }
+  memfault_unlock();
+  return rv;
+}
+
 int memfault_metrics_session_start(eMfltMetricsSessionIndex session_key) {
   MemfaultMetricsSessionStartCb session_start_cb = s_session_start_cbs[session_key];
   if (session_start_cb != NULL) {
@@ -932,12 +2182,21 @@ int memfault_metrics_session_start(eMfltMetricsSessionIndex session_key) {
   int rv;
   memfault_lock();
   {
+#if MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+    // The previous end of this session is still waiting on the snapshot and its values are about
+    // to be reset, so it is dropped
+    if (s_memfault_metrics_snapshot.end_pending[session_key]) {
+      s_memfault_metrics_snapshot.end_pending[session_key] = false;
+      MEMFAULT_LOG_WARN("Session %d restarted before it was serialized", (int)session_key);
+    }
+#endif
+
     // Reset all metrics for the session. Any changes that happened before the
     // session was started don't matter and can be discarded.
     prv_reset_metrics(false, session_key);
 
     MemfaultMetricId key = s_memfault_metrics_session_timer_keys[session_key];
-    rv = prv_find_timer_metric_and_update(key, kMemfaultTimerOp_Start);
+    rv = prv_find_timer_metric_and_update(NULL, key, kMemfaultTimerOp_Start);
   }
   memfault_unlock();
 
@@ -951,11 +2210,22 @@ int memfault_metrics_session_end(eMfltMetricsSessionIndex session_key) {
   }
 
   int rv;
+#if MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+  bool from_snapshot = false;
+#endif
   memfault_lock();
   {
     MemfaultMetricId key = s_memfault_metrics_session_timer_keys[session_key];
-    rv = prv_find_timer_metric_and_update(key, kMemfaultTimerOp_Stop);
+    rv = prv_find_timer_metric_and_update(NULL, key, kMemfaultTimerOp_Stop);
 
+#if MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+    if (rv == 0) {
+      from_snapshot = prv_snapshot_take(session_key);
+      // If the snapshot is still being serialized, storage can't take another event. Its owner
+      // serializes this session from it next, before releasing it.
+      s_memfault_metrics_snapshot.end_pending[session_key] = !from_snapshot;
+    }
+#else
     if (rv == 0) {
       bool serialize_result =
         memfault_metrics_session_serialize(s_memfault_metrics_ctx.storage_impl, session_key);
@@ -963,9 +2233,16 @@ int memfault_metrics_session_end(eMfltMetricsSessionIndex session_key) {
         rv = MEMFAULT_METRICS_STORAGE_TOO_SMALL;
       }
     }
+#endif
   }
   memfault_unlock();
 
+#if MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+  if (from_snapshot && !prv_snapshot_serialize_and_release()) {
+    rv = MEMFAULT_METRICS_STORAGE_TOO_SMALL;
+  }
+#endif
+
   return rv;
 }
 
@@ -983,6 +2260,296 @@ void memfault_metrics_session_register_end_cb(eMfltMetricsSessionIndex session_k
   memfault_unlock();
 }
 
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+//! Bytes of storage a non-scalar metric takes after the header of a bank, 0 for scalars which
+//! are held in the value union itself
+static size_t prv_session_instance_storage_size(const sMemfaultMetricKVPair *kv_pair) {
+  switch (kv_pair->type) {
+    case kMemfaultMetricType_String:
+      return (size_t)kv_pair->range + 1 /* for NUL */;
+    case kMemfaultMetricType_Histogram:
+      return sizeof(sMemfaultMetricHistogram);
+    case kMemfaultMetricType_HighResTimer:
+      return sizeof(sMemfaultMetricHighResTimer);
+    case kMemfaultMetricType_Unsigned64:
+    case kMemfaultMetricType_Signed64:
+      return sizeof(sMemfaultMetricValue64);
+    case kMemfaultMetricType_TimeSeries:
+      return sizeof(sMemfaultMetricTimeSeries);
+    case kMemfaultMetricType_Timer:
+    case kMemfaultMetricType_Signed:
+    case kMemfaultMetricType_Unsigned:
+    case kMemfaultMetricType_NumTypes:  // To silence -Wswitch-enum
+    default:
+      return 0;
+  }
+}
+
+//! Compute the size of the bank of an instance of 'session_key'. When 'instance' is not NULL its
+//! bank is also reset, with the value union of every non-scalar metric pointed at its storage.
+static size_t prv_session_instance_layout(eMfltMetricsSessionIndex session_key,
+                                          const sMfltMetricsSessionInstance *instance) {
+  prv_session_keys_init();
+  const uint16_t *offsets = s_memfault_metrics_session_keys.offsets;
+  size_t size =
+    prv_session_instance_header_size((size_t)(offsets[session_key + 1] - offsets[session_key]));
+
+  sMfltMetricsSessionBank bank = { 0 };
+  if (instance != NULL) {
+    bank = prv_session_instance_bank(instance);
+    memset(bank.values, 0, instance->size);
+  }
+
+  for (size_t i = offsets[session_key]; i < offsets[session_key + 1]; ++i) {
+    const sMemfaultMetricKVPair *const kv_pair =
+      &s_memfault_heartbeat_keys[s_memfault_metrics_session_keys.key_indices[i]];
+    const size_t storage_size = prv_session_instance_storage_size(kv_pair);
+    if (storage_size == 0) {
+      continue;
+    }
+
+    if (instance != NULL) {
+      void *storage = (uint8_t *)bank.values + size;
+      bank.values[i - offsets[session_key]].ptr = storage;
+      if (kv_pair->type == kMemfaultMetricType_TimeSeries) {
+        prv_time_series_reset(storage);
+      }
+    }
+    size += MEMFAULT_METRICS_BANK_ALIGN(storage_size);
+  }
+
+  return size;
+}
+
+static bool prv_session_instance_bank_fits(size_t offset, size_t size) {
+  if (offset + size > sizeof(s_memfault_metrics_instance_arena)) {
+    return false;
+  }
+  for (size_t i = 0; i < MEMFAULT_METRICS_SESSION_MAX_INSTANCES; i++) {
+    const sMfltMetricsSessionInstance *instance = &s_memfault_metrics_instances[i];
+    if (instance->in_use && (offset < instance->offset + instance->size) &&
+        (instance->offset < offset + size)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+//! Take a free slot and the lowest free range of the arena that fits a bank for 'session_key'.
+//! Banks only start at the beginning of the arena or right after another bank, which keeps the
+//! search quadratic in the number of instances rather than linear in the size of the arena.
+static sMfltMetricsSessionInstance *prv_session_instance_alloc(
+  eMfltMetricsSessionIndex session_key) {
+  const size_t size = prv_session_instance_layout(session_key, NULL);
+
+  sMfltMetricsSessionInstance *free_slot = NULL;
+  size_t best_offset = prv_session_instance_bank_fits(0, size) ? 0 : SIZE_MAX;
+  for (size_t i = 0; i < MEMFAULT_METRICS_SESSION_MAX_INSTANCES; i++) {
+    const sMfltMetricsSessionInstance *instance = &s_memfault_metrics_instances[i];
+    if (!instance->in_use) {
+      free_slot = (free_slot == NULL) ? &s_memfault_metrics_instances[i] : free_slot;
+      continue;
+    }
+    const size_t offset = instance->offset + instance->size;
+    if ((offset < best_offset) && prv_session_instance_bank_fits(offset, size)) {
+      best_offset = offset;
+    }
+  }
+
+  if ((free_slot == NULL) || (best_offset == SIZE_MAX)) {
+    return NULL;
+  }
+
+  *free_slot = (sMfltMetricsSessionInstance){
+    .in_use = true,
+    .generation = (uint8_t)(free_slot->generation + 1),
+    .session_key = session_key,
+    .offset = (uint32_t)best_offset,
+    .size = (uint32_t)size,
+  };
+  (void)prv_session_instance_layout(session_key, free_slot);
+  return free_slot;
+}
+
+static MemfaultMetricsSessionHandle prv_session_instance_handle(
+  const sMfltMetricsSessionInstance *instance) {
+  const size_t slot = (size_t)(instance - s_memfault_metrics_instances);
+  // +1 so the handle of a valid instance is never 0
+  return (MemfaultMetricsSessionHandle){ ._impl = (uint16_t)((instance->generation << 8) |
+                                                             (slot + 1)) };
+}
+
+static sMfltMetricsSessionInstance *prv_session_instance_find(
+  MemfaultMetricsSessionHandle handle) {
+  const size_t slot = (size_t)(handle._impl & 0xff) - 1;
+  if (slot >= MEMFAULT_METRICS_SESSION_MAX_INSTANCES) {
+    return NULL;
+  }
+
+  sMfltMetricsSessionInstance *instance = &s_memfault_metrics_instances[slot];
+  if (!instance->in_use || (instance->generation != (handle._impl >> 8))) {
+    return NULL;
+  }
+  return instance;
+}
+
+int memfault_metrics_session_instance_start(eMfltMetricsSessionIndex session_key,
+                                            MemfaultMetricsSessionHandle *handle) {
+  if ((handle == NULL) || (session_key >= MEMFAULT_METRICS_SESSION_KEY(heartbeat))) {
+    return MEMFAULT_METRICS_TYPE_BAD_PARAM;
+  }
+
+  int rv;
+  memfault_lock();
+  {
+    sMfltMetricsSessionInstance *instance = prv_session_instance_alloc(session_key);
+    if (instance == NULL) {
+      rv = MEMFAULT_METRICS_SESSION_INSTANCES_EXHAUSTED;
+    } else {
+      MemfaultMetricId key = s_memfault_metrics_session_timer_keys[session_key];
+      rv = prv_find_timer_metric_and_update(instance, key, kMemfaultTimerOp_Start);
+
+      *handle = prv_session_instance_handle(instance);
+    }
+  }
+  memfault_unlock();
+
+  return rv;
+}
+
+int memfault_metrics_session_instance_end(MemfaultMetricsSessionHandle handle) {
+  int rv;
+  memfault_lock();
+  {
+    sMfltMetricsSessionInstance *instance = prv_session_instance_find(handle);
+    if (instance == NULL) {
+      rv = MEMFAULT_METRICS_TYPE_BAD_PARAM;
+    } else {
+      const eMfltMetricsSessionIndex session_key = instance->session_key;
+
+      MemfaultMetricId key = s_memfault_metrics_session_timer_keys[session_key];
+      rv = prv_find_timer_metric_and_update(instance, key, kMemfaultTimerOp_Stop);
+      // The bank goes away with the instance, so count the time of the timers still running
+      prv_session_metric_iterator(instance, session_key, NULL, prv_tally_and_update_timer_cb);
+
+      // Always serialized with the lock held, even with MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT:
+      // event storage accepts one event at a time, so concurrent instance ends encoding outside
+      // the lock would drop each other's events
+      if ((rv == 0) && !memfault_metrics_session_instance_serialize(
+                         s_memfault_metrics_ctx.storage_impl, session_key, handle)) {
+        rv = MEMFAULT_METRICS_STORAGE_TOO_SMALL;
+      }
+
+      instance->in_use = false;
+    }
+  }
+  memfault_unlock();
+
+  return rv;
+}
+
+size_t memfault_metrics_session_instance_size(eMfltMetricsSessionIndex session_key) {
+  return prv_session_instance_layout(session_key, NULL);
+}
+
+// Body of the instance variant of a heartbeat API: run 'nolock_call' under memfault_lock() with
+// 'instance' set to the instance behind 'handle'
+  #define MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(handle, nolock_call)                         \
+    int rv;                                                                                    \
+    memfault_lock();                                                                           \
+    {                                                                                          \
+      const sMfltMetricsSessionInstance *instance = prv_session_instance_find(handle);         \
+      rv = (instance != NULL) ? (nolock_call) : MEMFAULT_METRICS_TYPE_BAD_PARAM;               \
+    }                                                                                          \
+    memfault_unlock();                                                                         \
+    return rv
+
+int memfault_metrics_session_instance_set_signed(MemfaultMetricsSessionHandle handle,
+                                                 MemfaultMetricId key, int32_t signed_value) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(
+    handle, prv_find_and_set_value_for_key(instance, key, kMemfaultMetricType_Signed,
+                                           &(union MemfaultMetricValue){ .i32 = signed_value }));
+}
+
+int memfault_metrics_session_instance_set_unsigned(MemfaultMetricsSessionHandle handle,
+                                                   MemfaultMetricId key, uint32_t unsigned_value) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(
+    handle, prv_find_and_set_value_for_key(instance, key, kMemfaultMetricType_Unsigned,
+                                           &(union MemfaultMetricValue){ .u32 = unsigned_value }));
+}
+
+int memfault_metrics_session_instance_set_signed64(MemfaultMetricsSessionHandle handle,
+                                                   MemfaultMetricId key, int64_t signed_value) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(
+    handle, prv_find_and_set_value64_for_key(instance, key, kMemfaultMetricType_Signed64,
+                                             (uint64_t)signed_value));
+}
+
+int memfault_metrics_session_instance_set_unsigned64(MemfaultMetricsSessionHandle handle,
+                                                     MemfaultMetricId key,
+                                                     uint64_t unsigned_value) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(
+    handle, prv_find_and_set_value64_for_key(instance, key, kMemfaultMetricType_Unsigned64,
+                                             unsigned_value));
+}
+
+int memfault_metrics_session_instance_set_string(MemfaultMetricsSessionHandle handle,
+                                                 MemfaultMetricId key, const char *value) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(handle, prv_set_string_nolock(instance, key, value));
+}
+
+int memfault_metrics_session_instance_timer_start(MemfaultMetricsSessionHandle handle,
+                                                  MemfaultMetricId key) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(
+    handle, prv_find_timer_metric_and_update(instance, key, kMemfaultTimerOp_Start));
+}
+
+int memfault_metrics_session_instance_timer_stop(MemfaultMetricsSessionHandle handle,
+                                                 MemfaultMetricId key) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(
+    handle, prv_find_timer_metric_and_update(instance, key, kMemfaultTimerOp_Stop));
+}
+
+int memfault_metrics_session_instance_add(MemfaultMetricsSessionHandle handle,
+                                          MemfaultMetricId key, int32_t amount) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(handle, prv_add_nolock(instance, key, amount));
+}
+
+int memfault_metrics_session_instance_record(MemfaultMetricsSessionHandle handle,
+                                             MemfaultMetricId key, uint32_t value) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(handle, prv_record_nolock(instance, key, value));
+}
+
+int memfault_metrics_session_instance_sample(MemfaultMetricsSessionHandle handle,
+                                             MemfaultMetricId key, int32_t value) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(handle, prv_sample_nolock(instance, key, value));
+}
+
+int memfault_metrics_session_instance_read_unsigned(MemfaultMetricsSessionHandle handle,
+                                                    MemfaultMetricId key, uint32_t *read_val) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(handle,
+                                          prv_read_unsigned_nolock(instance, key, read_val));
+}
+
+int memfault_metrics_session_instance_read_signed(MemfaultMetricsSessionHandle handle,
+                                                  MemfaultMetricId key, int32_t *read_val) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(handle,
+                                          prv_read_signed_nolock(instance, key, read_val));
+}
+
+int memfault_metrics_session_instance_timer_read(MemfaultMetricsSessionHandle handle,
+                                                 MemfaultMetricId key, uint32_t *read_val) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(handle, prv_timer_read_nolock(instance, key, read_val));
+}
+
+int memfault_metrics_session_instance_read_histogram(MemfaultMetricsSessionHandle handle,
+                                                     MemfaultMetricId key,
+                                                     sMemfaultMetricHistogram *read_val) {
+  MEMFAULT_METRICS_SESSION_INSTANCE_CALL_(handle,
+                                          prv_read_histogram_nolock(instance, key, read_val));
+}
+#endif
+
 typedef struct {
   MemfaultMetricIteratorCallback user_cb;
   void *user_ctx;
@@ -1018,27 +2585,72 @@ void memfault_metrics_heartbeat_iterate(MemfaultMetricIteratorCallback cb, void
   memfault_unlock();
 }
 
-typedef struct {
-  size_t num_metrics;
-  eMfltMetricsSessionIndex session_key;
-} sGetNumMetricsCtx;
-
-static bool prv_get_num_metrics_iter_cb(void *ctx, const sMemfaultMetricInfo *metric_info) {
-  sGetNumMetricsCtx *num_metrics_ctx = (sGetNumMetricsCtx *)ctx;
+void memfault_metrics_session_iterate(eMfltMetricsSessionIndex session_key,
+                                      MemfaultMetricIteratorCallback cb, void *ctx) {
+  memfault_lock();
+  {
+    sMetricHeartbeatIterateCtx user_ctx = {
+      .user_cb = cb,
+      .user_ctx = ctx,
+    };
+    prv_session_metric_iterator(NULL, session_key, &user_ctx, prv_metrics_heartbeat_iterate_cb);
+  }
+  memfault_unlock();
+}
 
-  if (metric_info->session_key == num_metrics_ctx->session_key) {
-    num_metrics_ctx->num_metrics++;
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+void memfault_metrics_session_instance_iterate_nolock(MemfaultMetricsSessionHandle handle,
+                                                      MemfaultMetricIteratorCallback cb,
+                                                      void *ctx) {
+  const sMfltMetricsSessionInstance *instance = prv_session_instance_find(handle);
+  if (instance == NULL) {
+    return;
   }
 
-  return true;
+  sMetricHeartbeatIterateCtx user_ctx = {
+    .user_cb = cb,
+    .user_ctx = ctx,
+  };
+  prv_session_metric_iterator(instance, instance->session_key, &user_ctx,
+                              prv_metrics_heartbeat_iterate_cb);
 }
+#endif
 
-static size_t prv_get_num_metrics(eMfltMetricsSessionIndex session_key) {
-  sGetNumMetricsCtx ctx = { .session_key = session_key };
+#if MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+void memfault_metrics_snapshot_iterate(eMfltMetricsSessionIndex session_key,
+                                       MemfaultMetricIteratorCallback cb, void *ctx) {
+  // The snapshot is only written while in_use is clear, so no lock is needed to read it
+  if (!s_memfault_metrics_snapshot.in_use ||
+      (s_memfault_metrics_snapshot.session_key != session_key)) {
+    return;
+  }
 
-  memfault_metrics_heartbeat_iterate(prv_get_num_metrics_iter_cb, (void *)&ctx);
+  const uint16_t *offsets = s_memfault_metrics_session_keys.offsets;
+  for (size_t i = offsets[session_key]; i < offsets[session_key + 1]; ++i) {
+    const size_t pos = i - offsets[session_key];
+    const sMemfaultMetricKVPair *const kv_pair =
+      &s_memfault_heartbeat_keys[s_memfault_metrics_session_keys.key_indices[i]];
+
+    sMemfaultMetricInfo info = {
+      .key = kv_pair->key,
+      .type = kv_pair->type,
+      .val = s_memfault_metrics_snapshot.values[pos],
+      .is_set = (s_memfault_metrics_snapshot.is_set_flags[pos >> MEMFAULT_IS_SET_FLAGS_DIVIDER] >>
+                 (pos % MEMFAULT_IS_SET_FLAGS_PER_BYTE)) &
+                0x01,
+      .session_key = kv_pair->session_key,
+    };
+    if (!cb(ctx, &info)) {
+      break;
+    }
+  }
+}
+#endif
 
-  return ctx.num_metrics;
+static size_t prv_get_num_metrics(eMfltMetricsSessionIndex session_key) {
+  prv_session_keys_init();
+  const uint16_t *offsets = s_memfault_metrics_session_keys.offsets;
+  return (size_t)(offsets[session_key + 1] - offsets[session_key]);
 }
 
 size_t memfault_metrics_heartbeat_get_num_metrics(void) {
@@ -1082,6 +2694,10 @@ static bool prv_metrics_debug_print(void *ctx, const sMemfaultMetricInfo *metric
     case kMemfaultMetricType_Timer:
       MEMFAULT_LOG_INFO("  %s: %" PRIu32, key_name, value->u32);
       break;
+    case kMemfaultMetricType_HighResTimer:
+      MEMFAULT_LOG_INFO("  %s: %" PRIu64 " ticks", key_name,
+                        ((const sMemfaultMetricHighResTimer *)value->ptr)->total_ticks);
+      break;
     case kMemfaultMetricType_Unsigned:
       if (metric_info->is_set) {
         MEMFAULT_LOG_INFO("  %s: %" PRIu32, key_name, value->u32);
@@ -1096,9 +2712,54 @@ static bool prv_metrics_debug_print(void *ctx, const sMemfaultMetricInfo *metric
         MEMFAULT_LOG_INFO("  %s: null", key_name);
       }
       break;
+    case kMemfaultMetricType_Unsigned64:
+      if (metric_info->is_set) {
+        MEMFAULT_LOG_INFO("  %s: %" PRIu64, key_name, prv_value64_read(value->ptr));
+      } else {
+        MEMFAULT_LOG_INFO("  %s: null", key_name);
+      }
+      break;
+    case kMemfaultMetricType_Signed64:
+      if (metric_info->is_set) {
+        MEMFAULT_LOG_INFO("  %s: %" PRIi64, key_name, (int64_t)prv_value64_read(value->ptr));
+      } else {
+        MEMFAULT_LOG_INFO("  %s: null", key_name);
+      }
+      break;
     case kMemfaultMetricType_String:
       MEMFAULT_LOG_INFO("  %s: \"%s\"", key_name, (const char *)value->ptr);
       break;
+    case kMemfaultMetricType_Histogram: {
+      const sMemfaultMetricHistogram *histogram = value->ptr;
+      if (metric_info->is_set) {
+        MEMFAULT_LOG_INFO("  %s: count=%" PRIu32 " min=%" PRIu32 " max=%" PRIu32 " p50=%" PRIu32
+                          " p90=%" PRIu32 " p99=%" PRIu32,
+                          key_name, histogram->count, histogram->min, histogram->max,
+                          memfault_metrics_histogram_percentile(histogram, 50),
+                          memfault_metrics_histogram_percentile(histogram, 90),
+                          memfault_metrics_histogram_percentile(histogram, 99));
+      } else {
+        MEMFAULT_LOG_INFO("  %s: null", key_name);
+      }
+      break;
+    }
+
+    case kMemfaultMetricType_TimeSeries: {
+      const sMemfaultMetricTimeSeries *time_series = value->ptr;
+      sMemfaultMetricTimeSeriesSample pending[2];
+      const size_t num_pending = memfault_metrics_time_series_pending_samples(time_series, pending);
+      if (metric_info->is_set) {
+        const sMemfaultMetricTimeSeriesSample *last =
+          (num_pending != 0) ? &pending[num_pending - 1] :
+                               &time_series->samples[time_series->num_samples - 1];
+        MEMFAULT_LOG_INFO("  %s: samples=%u level=%u last=%" PRIi32 " @%" PRIu32 "ms", key_name,
+                          (unsigned)(time_series->num_samples + num_pending),
+                          (unsigned)time_series->level, last->value, last->offset_ms);
+      } else {
+        MEMFAULT_LOG_INFO("  %s: null", key_name);
+      }
+      break;
+    }
 
     case kMemfaultMetricType_NumTypes:  // To silence -Wswitch-enum
     default:
@@ -1128,7 +2789,7 @@ void memfault_metrics_session_debug_print(eMfltMetricsSessionIndex session_key)
     .session_key = session_key,
     .print_filter = &prv_session_debug_print_filter,
   };
-  memfault_metrics_heartbeat_iterate(prv_metrics_debug_print, (void *)&ctx);
+  memfault_metrics_session_iterate(session_key, prv_metrics_debug_print, (void *)&ctx);
 }
 
 void memfault_metrics_all_sessions_debug_print(void) {
@@ -1155,6 +2816,7 @@ int memfault_metrics_boot(const sMemfaultEventStorageImpl *storage_impl,
   }
 
   s_memfault_metrics_ctx.storage_impl = storage_impl;
+  prv_session_keys_init();
   prv_reset_metrics(true, MEMFAULT_METRICS_SESSION_KEY(heartbeat));
 
   const bool success = memfault_platform_metrics_timer_boot(
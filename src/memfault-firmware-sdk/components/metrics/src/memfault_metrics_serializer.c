@@ -20,23 +20,66 @@
 #include "memfault-firmware-sdk/components/include/memfault/core/debug_log.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/event_storage.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/event_storage_implementation.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/math.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/platform/device_info.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/platform/overrides.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/sdk_assert.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/serializer_helper.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/serializer_key_ids.h"
 #include "memfault-firmware-sdk/components/include/memfault/metrics/utils.h"
 #include "memfault-firmware-sdk/components/include/memfault/util/cbor.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/varint.h"
+
+//! Visits the metrics of a session, either the live values or the serialization snapshot
+typedef void (*MemfaultMetricsSessionIterator)(eMfltMetricsSessionIndex session_key,
+                                               MemfaultMetricIteratorCallback cb, void *ctx);
 
 typedef struct {
   sMemfaultCborEncoder encoder;
   bool compute_worst_case_size;
   bool encode_success;
   eMfltMetricsSessionIndex session;
+  MemfaultMetricsSessionIterator iterate;
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+  //! Instance whose values are visited by prv_session_instance_iterate()
+  MemfaultMetricsSessionHandle instance;
+#endif
+#if MEMFAULT_METRICS_SPARSE_ENCODING
+  //! Position of the metric being visited within its session, used as the key in the sparse map
+  size_t metric_index;
+  size_t num_metrics_encoded;
+#endif
 } sMemfaultSerializerState;
 
+//! Metrics which would be encoded as a null value: integers which were never set and
+//! histograms and time series with no samples recorded
+static bool prv_metric_is_unset(const sMemfaultSerializerState *state,
+                                const sMemfaultMetricInfo *metric_info) {
+  if (state->compute_worst_case_size) {
+    return false;
+  }
+
+  switch (metric_info->type) {
+    case kMemfaultMetricType_Unsigned:
+    case kMemfaultMetricType_Signed:
+    case kMemfaultMetricType_Unsigned64:
+    case kMemfaultMetricType_Signed64:
+    case kMemfaultMetricType_Histogram:
+    case kMemfaultMetricType_TimeSeries:
+      return !metric_info->is_set;
+    case kMemfaultMetricType_Timer:
+    case kMemfaultMetricType_String:
+    case kMemfaultMetricType_HighResTimer:
+    case kMemfaultMetricType_NumTypes:  // silence error with -Wswitch-enum
+    default:
+      return false;
+  }
+}
+
 static bool prv_metric_heartbeat_write_integer(sMemfaultSerializerState *state,
                                                sMemfaultCborEncoder *encoder,
                                                const sMemfaultMetricInfo *metric_info) {
-  if (!metric_info->is_set && !state->compute_worst_case_size) {
+  if (prv_metric_is_unset(state, metric_info)) {
     return memfault_cbor_encode_null(encoder);
   }
 
@@ -50,19 +93,176 @@ static bool prv_metric_heartbeat_write_integer(sMemfaultSerializerState *state,
     return memfault_cbor_encode_signed_integer(encoder, value);
   }
 
+  if ((metric_info->type == kMemfaultMetricType_Unsigned64) ||
+      (metric_info->type == kMemfaultMetricType_Signed64)) {
+    const sMemfaultMetricValue64 *value64 = metric_info->val.ptr;
+    const uint64_t value = ((uint64_t)value64->hi << 32) | value64->lo;
+    if (metric_info->type == kMemfaultMetricType_Unsigned64) {
+      return memfault_cbor_encode_long_unsigned_integer(
+        encoder, state->compute_worst_case_size ? UINT64_MAX : value);
+    }
+    return memfault_cbor_encode_long_signed_integer(
+      encoder, state->compute_worst_case_size ? INT64_MIN : (int64_t)value);
+  }
+
   // Should be unreachable
   return false;
 }
 
+//! Histograms are encoded as an array of [count, min, max, sum, bucket 0, ..., bucket N]. Trailing
+//! empty buckets are dropped so only the buckets up to the largest value recorded are sent.
+static bool prv_metric_heartbeat_write_histogram(sMemfaultSerializerState *state,
+                                                 sMemfaultCborEncoder *encoder,
+                                                 const sMemfaultMetricInfo *metric_info) {
+  if (prv_metric_is_unset(state, metric_info)) {
+    return memfault_cbor_encode_null(encoder);
+  }
+
+  sMemfaultMetricHistogram histogram;
+  if (state->compute_worst_case_size) {
+    histogram = (sMemfaultMetricHistogram){
+      .count = UINT32_MAX,
+      .min = UINT32_MAX,
+      .max = UINT32_MAX,
+      .sum = INT64_MAX,
+    };
+    for (size_t i = 0; i < MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS; i++) {
+      histogram.buckets[i] = UINT16_MAX;
+    }
+  } else {
+    histogram = *(const sMemfaultMetricHistogram *)metric_info->val.ptr;
+  }
+
+  size_t num_buckets = MEMFAULT_METRICS_HISTOGRAM_NUM_BUCKETS;
+  while ((num_buckets > 0) && (histogram.buckets[num_buckets - 1] == 0)) {
+    num_buckets--;
+  }
+
+  // The sum can only exceed INT64_MAX after ~2^31 samples of UINT32_MAX, clip it if it does
+  const int64_t sum = (int64_t)MEMFAULT_MIN(histogram.sum, (uint64_t)INT64_MAX);
+
+  if (!memfault_cbor_encode_array_begin(encoder, 4 + num_buckets) ||
+      !memfault_cbor_encode_unsigned_integer(encoder, histogram.count) ||
+      !memfault_cbor_encode_unsigned_integer(encoder, histogram.min) ||
+      !memfault_cbor_encode_unsigned_integer(encoder, histogram.max) ||
+      !memfault_cbor_encode_long_signed_integer(encoder, sum)) {
+    return false;
+  }
+
+  for (size_t i = 0; i < num_buckets; i++) {
+    if (!memfault_cbor_encode_unsigned_integer(encoder, histogram.buckets[i])) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+//! High resolution timers are encoded as [ticks, ticks per second]. The tick rate is the unit of
+//! the value, i.e. 1000000 for a microsecond timer or the CPU clock for a cycle counter.
+static bool prv_metric_heartbeat_write_high_res_timer(sMemfaultSerializerState *state,
+                                                      sMemfaultCborEncoder *encoder,
+                                                      const sMemfaultMetricInfo *metric_info) {
+  const uint64_t ticks =
+    state->compute_worst_case_size ?
+      UINT64_MAX :
+      ((const sMemfaultMetricHighResTimer *)metric_info->val.ptr)->total_ticks;
+
+  return memfault_cbor_encode_array_begin(encoder, 2) &&
+         memfault_cbor_encode_long_signed_integer(
+           encoder, (int64_t)MEMFAULT_MIN(ticks, (uint64_t)INT64_MAX)) &&
+         memfault_cbor_encode_unsigned_integer(encoder,
+                                               MEMFAULT_METRICS_HIGH_RES_TIMER_TICKS_PER_SEC);
+}
+
+//! Time series are encoded as a byte string of (time delta in ms, value delta) pairs, both varints
+//! and the value delta zigzag encoded. The first pair is relative to (start of the interval, 0).
+static size_t prv_time_series_encode_pair(const sMemfaultMetricTimeSeriesSample *sample,
+                                          sMemfaultMetricTimeSeriesSample *prev, uint8_t *buf) {
+  size_t len = memfault_encode_varint_u32(sample->offset_ms - prev->offset_ms, buf);
+  // wraps around the same way on decode, so any two int32_t values have a delta
+  len += memfault_encode_varint_si32((int32_t)((uint32_t)sample->value - (uint32_t)prev->value),
+                                     &buf[len]);
+  *prev = *sample;
+  return len;
+}
+
+//! Joins the encoded pairs of a time series, or only sums up their length if 'encoder' is NULL
+static bool prv_time_series_join_pairs(sMemfaultCborEncoder *encoder,
+                                       const sMemfaultMetricTimeSeries *time_series,
+                                       size_t *len_out) {
+  sMemfaultMetricTimeSeriesSample pending[2];
+  const size_t num_pending = memfault_metrics_time_series_pending_samples(time_series, pending);
+  const size_t num_samples = time_series->num_samples;
+
+  sMemfaultMetricTimeSeriesSample prev = { 0 };
+  size_t len = 0;
+  for (size_t i = 0; i < num_samples + num_pending; i++) {
+    const sMemfaultMetricTimeSeriesSample *sample =
+      (i < num_samples) ? &time_series->samples[i] : &pending[i - num_samples];
+    uint8_t buf[MEMFAULT_METRICS_TIME_SERIES_MAX_PAIR_LEN];
+    const size_t pair_len = prv_time_series_encode_pair(sample, &prev, buf);
+    if ((encoder != NULL) && !memfault_cbor_join(encoder, buf, pair_len)) {
+      return false;
+    }
+    len += pair_len;
+  }
+
+  if (len_out != NULL) {
+    *len_out = len;
+  }
+  return true;
+}
+
+static bool prv_metric_heartbeat_write_time_series(sMemfaultSerializerState *state,
+                                                   sMemfaultCborEncoder *encoder,
+                                                   const sMemfaultMetricInfo *metric_info) {
+  if (prv_metric_is_unset(state, metric_info)) {
+    return memfault_cbor_encode_null(encoder);
+  }
+
+  if (state->compute_worst_case_size) {
+    // every sample slot plus the partial bucket's min and max, each with the widest deltas
+    const size_t num_pairs = MEMFAULT_METRICS_TIME_SERIES_NUM_SAMPLES + 2;
+    sMemfaultMetricTimeSeriesSample prev = { .offset_ms = 0, .value = INT32_MAX };
+    const sMemfaultMetricTimeSeriesSample sample = { .offset_ms = UINT32_MAX, .value = -1 };
+    uint8_t buf[MEMFAULT_METRICS_TIME_SERIES_MAX_PAIR_LEN];
+    const size_t pair_len = prv_time_series_encode_pair(&sample, &prev, buf);
+    if (!memfault_cbor_encode_byte_string_begin(encoder, num_pairs * pair_len)) {
+      return false;
+    }
+    for (size_t i = 0; i < num_pairs; i++) {
+      if (!memfault_cbor_join(encoder, buf, pair_len)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const sMemfaultMetricTimeSeries *time_series = metric_info->val.ptr;
+  size_t len;
+  return prv_time_series_join_pairs(NULL, time_series, &len) &&
+         memfault_cbor_encode_byte_string_begin(encoder, len) &&
+         prv_time_series_join_pairs(encoder, time_series, NULL);
+}
+
 static bool prv_metric_heartbeat_writer(void *ctx, const sMemfaultMetricInfo *metric_info) {
   sMemfaultSerializerState *state = (sMemfaultSerializerState *)ctx;
   sMemfaultCborEncoder *encoder = &state->encoder;
 
-  // only encode metrics for the session we are interested in
-  if (metric_info->session_key != state->session) {
+#if MEMFAULT_METRICS_SPARSE_ENCODING
+  // unset metrics are left out of the sparse map entirely, everything else is keyed by its
+  // position in the session
+  const size_t metric_index = state->metric_index++;
+  if (prv_metric_is_unset(state, metric_info)) {
     state->encode_success = true;
     return state->encode_success;
   }
+  if (!memfault_cbor_encode_unsigned_integer(encoder, metric_index)) {
+    state->encode_success = false;
+    return state->encode_success;
+  }
+#endif
 
   // encode the value
   switch (metric_info->type) {
@@ -72,7 +272,9 @@ static bool prv_metric_heartbeat_writer(void *ctx, const sMemfaultMetricInfo *me
       break;
     }
     case kMemfaultMetricType_Unsigned:
-    case kMemfaultMetricType_Signed: {
+    case kMemfaultMetricType_Signed:
+    case kMemfaultMetricType_Unsigned64:
+    case kMemfaultMetricType_Signed64: {
       state->encode_success = prv_metric_heartbeat_write_integer(state, encoder, metric_info);
       break;
     }
@@ -81,6 +283,19 @@ static bool prv_metric_heartbeat_writer(void *ctx, const sMemfaultMetricInfo *me
       state->encode_success = memfault_cbor_encode_string(encoder, value);
       break;
     }
+    case kMemfaultMetricType_Histogram: {
+      state->encode_success = prv_metric_heartbeat_write_histogram(state, encoder, metric_info);
+      break;
+    }
+    case kMemfaultMetricType_HighResTimer: {
+      state->encode_success =
+        prv_metric_heartbeat_write_high_res_timer(state, encoder, metric_info);
+      break;
+    }
+    case kMemfaultMetricType_TimeSeries: {
+      state->encode_success = prv_metric_heartbeat_write_time_series(state, encoder, metric_info);
+      break;
+    }
     case kMemfaultMetricType_NumTypes:  // silence error with -Wswitch-enum
     default:
       break;
@@ -90,6 +305,33 @@ static bool prv_metric_heartbeat_writer(void *ctx, const sMemfaultMetricInfo *me
   return state->encode_success;
 }
 
+#if MEMFAULT_METRICS_SPARSE_ENCODING
+static bool prv_count_set_metrics_cb(void *ctx, const sMemfaultMetricInfo *metric_info) {
+  sMemfaultSerializerState *state = (sMemfaultSerializerState *)ctx;
+  if (!prv_metric_is_unset(state, metric_info)) {
+    state->num_metrics_encoded++;
+  }
+  return true;
+}
+
+static bool prv_encode_metrics_begin(sMemfaultSerializerState *state) {
+  state->metric_index = 0;
+  state->num_metrics_encoded = 0;
+  state->iterate(state->session, prv_count_set_metrics_cb, state);
+
+  return memfault_cbor_encode_unsigned_integer(&state->encoder,
+                                               kMemfaultHeartbeatInfoKey_SparseMetrics) &&
+         memfault_cbor_encode_dictionary_begin(&state->encoder, state->num_metrics_encoded);
+}
+#else
+static bool prv_encode_metrics_begin(sMemfaultSerializerState *state) {
+  return memfault_cbor_encode_unsigned_integer(&state->encoder,
+                                               kMemfaultHeartbeatInfoKey_Metrics) &&
+         memfault_cbor_encode_array_begin(&state->encoder,
+                                          memfault_metrics_session_get_num_metrics(state->session));
+}
+#endif
+
 static bool prv_serialize_latest_heartbeat_and_deinit(sMemfaultSerializerState *state) {
   bool success = false;
 
@@ -103,13 +345,12 @@ static bool prv_serialize_latest_heartbeat_and_deinit(sMemfaultSerializerState *
       !memfault_cbor_encode_dictionary_begin(encoder, 2) ||
       !memfault_serializer_helper_encode_uint32_kv_pair(encoder, kMemfaultHeartbeatInfoKey_Session,
                                                         state->session) ||
-      !memfault_cbor_encode_unsigned_integer(encoder, kMemfaultHeartbeatInfoKey_Metrics) ||
-      !memfault_cbor_encode_array_begin(encoder,
-                                        memfault_metrics_session_get_num_metrics(state->session))) {
+      !prv_encode_metrics_begin(state)) {
     goto cleanup;
   }
 
-  memfault_metrics_heartbeat_iterate(prv_metric_heartbeat_writer, state);
+  // only encode metrics for the session we are interested in
+  state->iterate(state->session, prv_metric_heartbeat_writer, state);
   success = state->encode_success;
 
 cleanup:
@@ -122,13 +363,25 @@ static bool prv_encode_cb(MEMFAULT_UNUSED sMemfaultCborEncoder *encoder, void *c
 }
 
 static size_t prv_compute_worst_case_size(eMfltMetricsSessionIndex session) {
-  sMemfaultSerializerState state = { .compute_worst_case_size = true, .session = session };
+  sMemfaultSerializerState state = {
+    .compute_worst_case_size = true,
+    .session = session,
+    .iterate = memfault_metrics_session_iterate,
+  };
 
   return memfault_serializer_helper_compute_size(&state.encoder, prv_encode_cb, &state);
 }
 
 size_t memfault_metrics_heartbeat_compute_worst_case_storage_size(void) {
-  return prv_compute_worst_case_size(MEMFAULT_METRICS_SESSION_KEY(heartbeat));
+  const size_t worst_case_size =
+    memfault_serializer_helper_compute_metadata_worst_case_size(kMemfaultEventType_Heartbeat) +
+    MEMFAULT_METRICS_HEARTBEAT_MAX_METRICS_SIZE;
+#if MEMFAULT_METRICS_WORST_CASE_SIZE_CROSS_CHECK
+  // the dry-run encode visits every metric, only used to validate the compile-time bound
+  MEMFAULT_SDK_ASSERT(prv_compute_worst_case_size(MEMFAULT_METRICS_SESSION_KEY(heartbeat)) <=
+                      worst_case_size);
+#endif
+  return worst_case_size;
 }
 
 size_t memfault_metrics_session_compute_worst_case_storage_size(eMfltMetricsSessionIndex session) {
@@ -139,8 +392,8 @@ bool memfault_metrics_heartbeat_serialize(const sMemfaultEventStorageImpl *stora
   return memfault_metrics_session_serialize(storage_impl, MEMFAULT_METRICS_SESSION_KEY(heartbeat));
 }
 
-bool memfault_metrics_session_serialize(const sMemfaultEventStorageImpl *storage_impl,
-                                        eMfltMetricsSessionIndex session) {
+static bool prv_serialize_session(const sMemfaultEventStorageImpl *storage_impl,
+                                  sMemfaultSerializerState *state) {
   // Build a heartbeat event, which looks like this:
   // {
   //    "type": "heartbeat",
@@ -155,13 +408,59 @@ bool memfault_metrics_session_serialize(const sMemfaultEventStorageImpl *storage
   //    }
   // }
   // NOTE: "sdk_version" is not included, but derived from the CborSchemaVersion
+  // NOTE: With MEMFAULT_METRICS_SPARSE_ENCODING, "metrics" is replaced by "sparse_metrics", a
+  // map of { position of the metric in the session: value } holding only the metrics that are set
 
   // NOTE: We'll always attempt to serialize the heartbeat and rollback if we are out of space
   // avoiding the need to serialize the data twice
-  sMemfaultSerializerState state = { 0 };
-  state.session = session;
-  const bool success = memfault_serializer_helper_encode_to_storage(&state.encoder, storage_impl,
-                                                                    prv_encode_cb, &state);
+  const bool success = memfault_serializer_helper_encode_to_storage(&state->encoder, storage_impl,
+                                                                    prv_encode_cb, state);
+
+  return success;
+}
 
+bool memfault_metrics_session_serialize(const sMemfaultEventStorageImpl *storage_impl,
+                                        eMfltMetricsSessionIndex session) {
+  // The live values are visited more than once per event (the sparse map header counts the set
+  // metrics up front and time series are sized before they are joined), so hold the lock for the
+  // whole encode or a value set in between leaves a length that does not match the data
+  sMemfaultSerializerState state = {
+    .session = session,
+    .iterate = memfault_metrics_session_iterate,
+  };
+  memfault_lock();
+  const bool success = prv_serialize_session(storage_impl, &state);
+  memfault_unlock();
   return success;
 }
+
+#if MEMFAULT_METRICS_SERIALIZE_FROM_SNAPSHOT
+bool memfault_metrics_session_serialize_snapshot(const sMemfaultEventStorageImpl *storage_impl,
+                                                 eMfltMetricsSessionIndex session) {
+  sMemfaultSerializerState state = {
+    .session = session,
+    .iterate = memfault_metrics_snapshot_iterate,
+  };
+  return prv_serialize_session(storage_impl, &state);
+}
+#endif
+
+#if MEMFAULT_METRICS_SESSION_MAX_INSTANCES > 0
+//! The serializer always iterates with its state as the context, which holds the instance
+static void prv_session_instance_iterate(MEMFAULT_UNUSED eMfltMetricsSessionIndex session_key,
+                                         MemfaultMetricIteratorCallback cb, void *ctx) {
+  const sMemfaultSerializerState *state = (const sMemfaultSerializerState *)ctx;
+  memfault_metrics_session_instance_iterate_nolock(state->instance, cb, ctx);
+}
+
+bool memfault_metrics_session_instance_serialize(const sMemfaultEventStorageImpl *storage_impl,
+                                                 eMfltMetricsSessionIndex session,
+                                                 MemfaultMetricsSessionHandle handle) {
+  sMemfaultSerializerState state = {
+    .session = session,
+    .iterate = prv_session_instance_iterate,
+    .instance = handle,
+  };
+  return prv_serialize_session(storage_impl, &state);
+}
+#endif
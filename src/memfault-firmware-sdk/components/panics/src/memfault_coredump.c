@@ -12,14 +12,20 @@
 #include <stdbool.h>
 #include <string.h>
 
+#include "memfault-firmware-sdk/components/include/memfault/config.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/build_info.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/compiler.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/data_packetizer_source.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/debug_log.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/log_impl.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/math.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/platform/device_info.h"
 #include "memfault-firmware-sdk/components/include/memfault/panics/coredump.h"
 #include "memfault-firmware-sdk/components/include/memfault/panics/coredump_impl.h"
 #include "memfault-firmware-sdk/components/include/memfault/panics/platform/coredump.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/crc32.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/rle.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/varint.h"
 
 #define MEMFAULT_COREDUMP_MAGIC 0x45524f43
 
@@ -42,6 +48,8 @@ sMfltCoredumpHeader;
 
 typedef enum MfltCoredumpFooterFlags {
   kMfltCoredumpBlockType_SaveTruncated = 0,
+  //! kMfltCoredumpRegionType_Crc32 blocks were saved
+  kMfltCoredumpBlockType_BlockCrc32 = 1,
 } eMfltCoredumpFooterFlags;
 
 typedef MEMFAULT_PACKED_STRUCT MfltCoredumpFooter {
@@ -65,6 +73,16 @@ typedef MEMFAULT_PACKED_STRUCT MfltTraceReasonBlock {
 }
 sMfltTraceReasonBlock;
 
+//! Saved ahead of the memory block for a kMfltCoredumpRegionType_ThreadStack region
+typedef MEMFAULT_PACKED_STRUCT MfltThreadStackInfoBlock {
+  //! The lowest address of the stack
+  uint32_t stack_base;
+  uint32_t stack_size;
+  //! The most stack the thread has used, in bytes
+  uint32_t high_water_mark;
+}
+sMfltThreadStackInfoBlock;
+
 // Using ELF machine enum values which is a half word:
 //  https://refspecs.linuxfoundation.org/elf/gabi4%2B/ch4.eheader.html
 //
@@ -123,8 +141,65 @@ typedef struct {
   bool truncated;
   // set to true if a call to "memfault_platform_coredump_storage_write" failed
   bool write_error;
+  // set to true when storage is erased one sector at a time ahead of writes
+  bool erase_lazily;
+  // the offset up to which storage has been erased when erase_lazily is set
+  uint32_t erased_offset;
+  // the erase granularity and total size of coredump storage when erase_lazily is set
+  uint32_t sector_size;
+  uint32_t erase_limit;
+  // the offset within coredump storage of the slot being written. All other offsets are
+  // relative to the start of the slot
+  uint32_t slot_base;
+  // the CRC32 of everything written since crc_start_offset
+  uint32_t crc;
+  uint32_t crc_start_offset;
+  // set to true when writes go to the RAM snapshot rather than coredump storage
+  bool to_ram_snapshot;
 } sMfltCoredumpWriteCtx;
 
+//! The storage used by a kMfltCoredumpRegionType_Crc32 block
+#define MEMFAULT_COREDUMP_CRC_BLOCK_SIZE (sizeof(sMfltCoredumpBlock) + sizeof(uint32_t))
+
+MEMFAULT_STATIC_ASSERT((MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS >= 1) &&
+                         (MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS <= 32),
+                       "MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS must be between 1 and 32");
+
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+//! A RAM copy of the slot directory: which slots currently hold a valid coredump.
+//!
+//! The directory itself is the header at the start of each slot so nothing extra needs to be
+//! persisted. The copy is rebuilt from the headers whenever coredump storage is polled at runtime
+//! and kept up to date as slots are saved and cleared, so finding a free slot from the fault
+//! handler only needs to read the header of the slot picked.
+typedef struct {
+  bool populated;
+  //! Bit N set when slot N holds a valid coredump
+  uint32_t used_mask;
+  //! The slot being drained by g_memfault_coredump_data_source
+  uint32_t read_slot;
+} sMfltCoredumpSlotDirectory;
+
+static sMfltCoredumpSlotDirectory s_mflt_coredump_slot_dir;
+#endif
+
+#if MEMFAULT_COREDUMP_STORAGE_PRE_ERASE
+//! The offset up to which storage has been erased by memfault_coredump_storage_pre_erase_step()
+//! since boot
+static uint32_t s_mflt_coredump_pre_erased_offset;
+static bool s_mflt_coredump_pre_erase_complete;
+#endif
+
+#if MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0
+MEMFAULT_STATIC_ASSERT((MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE % 4) == 0,
+                       "MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE must be a multiple of 4");
+
+//! Retained RAM the fault handler saves a coredump to. The contents are laid out exactly as they
+//! would be in coredump storage so the header is written last to mark the snapshot valid.
+MEMFAULT_PUT_IN_SECTION(MEMFAULT_COREDUMP_RAM_SNAPSHOT_SECTION_NAME)
+static uint32_t s_mflt_coredump_snapshot[MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE / 4];
+#endif
+
 // Checks to see if the block is a cached region and applies
 // required fixups to allow the coredump to properly record
 // the original cached address and its associated data. Will
@@ -155,20 +230,338 @@ static bool prv_fixup_if_cached_block(sMfltCoredumpRegion *region, uint32_t *cac
   return true;
 }
 
+//! Shrink a thread stack region down to the part of the stack which has been used
+//!
+//! @param scan_stack When false the entire stack is kept, i.e when computing the worst case
+//!  coredump size
+//! @return true if the region is a thread stack, false otherwise
+static bool prv_fixup_if_thread_stack(sMfltCoredumpRegion *region, uint32_t *address,
+                                      bool scan_stack) {
+  if (region->type != kMfltCoredumpRegionType_ThreadStack) {
+    return false;
+  }
+  region->type = kMfltCoredumpRegionType_Memory;
+  if (!scan_stack || (region->region_start == NULL)) {
+    return true;
+  }
+
+  // The stack grows down so the fill pattern is scanned for from the base upwards a word at a
+  // time. Any unaligned bytes at the base are treated as unused
+  const uintptr_t stack_base = (uintptr_t)region->region_start;
+  const uintptr_t stack_top = stack_base + region->region_size;
+  const uint32_t *word = (const uint32_t *)((stack_base + 3) & ~(uintptr_t)3);
+  const uint32_t *stack_top_word = (const uint32_t *)(stack_top & ~(uintptr_t)3);
+  while ((word < stack_top_word) && (*word == MEMFAULT_COREDUMP_STACK_FILL_WORD)) {
+    word++;
+  }
+
+  region->region_start = word;
+  region->region_size = stack_top - (uintptr_t)word;
+  *address = (uint32_t)(uintptr_t)word;
+  return true;
+}
+
+//! Cut a region down to size bytes
+//!
+//! Regions keep their first size bytes. A thread stack grows down, so its lowest addresses hold
+//! the stale space left behind by deeper calls. A thread stack keeps the size bytes below the top
+//! of the stack instead.
+static void prv_trim_region(sMfltCoredumpRegion *region, uint32_t *address, uint32_t size,
+                            bool thread_stack) {
+  if (size >= region->region_size) {
+    return;
+  }
+  if (thread_stack) {
+    const uintptr_t start = (uintptr_t)region->region_start + (region->region_size - size);
+    region->region_start = (const void *)start;
+    *address = (uint32_t)start;
+  }
+  region->region_size = size;
+}
+
+//! Erase any sectors not yet erased which a write ending at end_offset touches
+static bool prv_erase_ahead_of_write(sMfltCoredumpWriteCtx *write_ctx, uint32_t end_offset) {
+  while (write_ctx->erased_offset < end_offset) {
+    const uint32_t erase_size =
+      MEMFAULT_MIN(write_ctx->sector_size, write_ctx->erase_limit - write_ctx->erased_offset);
+    if ((erase_size == 0) ||
+        !memfault_platform_coredump_storage_erase(write_ctx->slot_base + write_ctx->erased_offset,
+                                                  erase_size)) {
+      return false;
+    }
+    write_ctx->erased_offset += erase_size;
+  }
+  return true;
+}
+
+static bool prv_storage_write(sMfltCoredumpWriteCtx *write_ctx, uint32_t offset, const void *data,
+                              size_t len) {
+#if MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0
+  if (write_ctx->to_ram_snapshot) {
+    if ((offset + len) > sizeof(s_mflt_coredump_snapshot)) {
+      return false;
+    }
+    memcpy(&((uint8_t *)s_mflt_coredump_snapshot)[offset], data, len);
+    return true;
+  }
+#endif
+  if (write_ctx->erase_lazily && !prv_erase_ahead_of_write(write_ctx, offset + len)) {
+    return false;
+  }
+#if MEMFAULT_COREDUMP_STORAGE_PRE_ERASE
+  // storage is dirty again, so the sectors erased in the background have to be erased again, i.e
+  // when memfault_coredump_snapshot_commit() writes a coredump during the same boot
+  memfault_coredump_storage_pre_erase_reset();
+#endif
+  return memfault_platform_coredump_storage_write(write_ctx->slot_base + offset, data, len);
+}
+
+#if MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE > 0
+
+MEMFAULT_STATIC_ASSERT((MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE % 4) == 0,
+                       "MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE must be a multiple of 4");
+
+//! Staging area used to combine small coredump writes into fewer, larger storage writes.
+//!
+//! The buffer always mirrors a window of coredump storage which starts at a multiple of
+//! MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE so flushes never straddle a page boundary.
+typedef struct {
+  //! The storage offset the first buffered byte is destined for
+  uint32_t start_offset;
+  //! The number of bytes currently buffered
+  uint32_t len;
+  uint32_t data[MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE / 4];
+} sMfltCoredumpWriteBuffer;
+
+static sMfltCoredumpWriteBuffer s_mflt_coredump_write_buf;
+
+static bool prv_write_buffer_flush(sMfltCoredumpWriteCtx *write_ctx) {
+  sMfltCoredumpWriteBuffer *wbuf = &s_mflt_coredump_write_buf;
+  if (wbuf->len == 0) {
+    return true;
+  }
+
+  const uint8_t *buf = (const uint8_t *)wbuf->data;
+  const size_t page_offset = wbuf->start_offset % MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE;
+  const bool success =
+    prv_storage_write(write_ctx, wbuf->start_offset, &buf[page_offset], wbuf->len);
+  wbuf->start_offset += wbuf->len;
+  wbuf->len = 0;
+  if (!success) {
+    write_ctx->write_error = true;
+  }
+  return success;
+}
+
+static bool prv_write_buffer_append(const void *data, size_t len,
+                                    sMfltCoredumpWriteCtx *write_ctx) {
+  sMfltCoredumpWriteBuffer *wbuf = &s_mflt_coredump_write_buf;
+
+  // a write which isn't contiguous with what is buffered (i.e the header write at offset 0)
+  // starts a new window
+  if ((wbuf->start_offset + wbuf->len) != write_ctx->offset) {
+    if (!prv_write_buffer_flush(write_ctx)) {
+      return false;
+    }
+    wbuf->start_offset = write_ctx->offset;
+  }
+
+  const size_t page_size = MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE;
+  uint8_t *buf = (uint8_t *)wbuf->data;
+  const uint8_t *src = data;
+  while (len > 0) {
+    const size_t page_offset = (wbuf->start_offset + wbuf->len) % page_size;
+    const size_t bytes_to_copy = MEMFAULT_MIN(len, page_size - page_offset);
+    memcpy(&buf[page_offset], src, bytes_to_copy);
+    wbuf->len += bytes_to_copy;
+    src += bytes_to_copy;
+    len -= bytes_to_copy;
+
+    if ((page_offset + bytes_to_copy) == page_size) {
+      if (!prv_write_buffer_flush(write_ctx)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+#endif /* MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE > 0 */
+
 static bool prv_platform_coredump_write(const void *data, size_t len,
                                         sMfltCoredumpWriteCtx *write_ctx) {
   // if we are just computing the size needed, don't write any data but keep
   // a count of how many bytes would be written.
-  if (!write_ctx->compute_size_only &&
-      !memfault_platform_coredump_storage_write(write_ctx->offset, data, len)) {
-    write_ctx->write_error = true;
-    return false;
+  if (!write_ctx->compute_size_only) {
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+    write_ctx->crc = memfault_crc32_compute(write_ctx->crc, data, len);
+#endif
+#if MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE > 0
+    if (!prv_write_buffer_append(data, len, write_ctx)) {
+      return false;
+    }
+#else
+    if (!prv_storage_write(write_ctx, write_ctx->offset, data, len)) {
+      write_ctx->write_error = true;
+      return false;
+    }
+#endif
   }
 
   write_ctx->offset += len;
   return true;
 }
 
+//! Push any writes which have been staged out to coredump storage
+static bool prv_platform_coredump_write_flush(MEMFAULT_UNUSED sMfltCoredumpWriteCtx *write_ctx) {
+#if MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE > 0
+  if (!write_ctx->compute_size_only) {
+    return prv_write_buffer_flush(write_ctx);
+  }
+#endif
+  return true;
+}
+
+#if MEMFAULT_COREDUMP_COMPRESS_REGIONS
+
+//! A kMfltCoredumpRegionType_MemoryRegionRle block payload is this header followed by the region
+//! run length encoded in the format described in memfault/util/rle.h and then zero padding.
+//!
+//! Decoding stops once decoded_size bytes have been produced or the block ends. Padding is only
+//! present if the region was truncated or its contents changed between sizing and writing it.
+typedef MEMFAULT_PACKED_STRUCT MfltCoredumpRleBlockHeader {
+  uint32_t decoded_size;
+}
+sMfltCoredumpRleBlockHeader;
+
+//! Kept in static storage to keep stack usage in the fault handler down
+static sMemfaultRleCtx s_mflt_coredump_rle_ctx;
+
+//! Write as much of a run of literal bytes as fits in max_encoded_size
+//!
+//! @return the number of encoded bytes written
+static uint32_t prv_rle_write_partial_literal_seq(const uint8_t *data, uint32_t max_encoded_size,
+                                                  sMfltCoredumpWriteCtx *write_ctx) {
+  uint8_t header[MEMFAULT_UINT32_MAX_VARINT_LENGTH];
+  size_t header_len = 0;
+  int32_t seq_len = (int32_t)max_encoded_size;
+  do {
+    seq_len--;
+    header_len = memfault_encode_varint_si32(-seq_len, header);
+  } while ((seq_len > 0) && ((header_len + (uint32_t)seq_len) > max_encoded_size));
+
+  if ((seq_len <= 0) || ((write_ctx != NULL) &&
+                         (!prv_platform_coredump_write(header, header_len, write_ctx) ||
+                          !prv_platform_coredump_write(data, (size_t)seq_len, write_ctx)))) {
+    return 0;
+  }
+  return header_len + (uint32_t)seq_len;
+}
+
+//! Run length encode a region
+//!
+//! @param max_encoded_size Sequences which would take the encoding past this size are dropped
+//! @param write_ctx When non-NULL, encoded sequences are written out to storage
+//! @param complete_out Set to false if the region did not fit in max_encoded_size
+//! @return The size of the encoded sequences
+static uint32_t prv_rle_encode_region(const uint8_t *data, size_t data_len,
+                                      uint32_t max_encoded_size, sMfltCoredumpWriteCtx *write_ctx,
+                                      bool *complete_out) {
+  sMemfaultRleCtx *rle_ctx = &s_mflt_coredump_rle_ctx;
+  *rle_ctx = (sMemfaultRleCtx){ 0 };
+
+  uint32_t encoded_size = 0;
+  size_t offset = 0;
+  bool finalized = false;
+  *complete_out = true;
+  while (!finalized) {
+    if (offset < data_len) {
+      offset += memfault_rle_encode(rle_ctx, &data[offset], data_len - offset);
+    } else {
+      memfault_rle_encode_finalize(rle_ctx);
+      finalized = true;
+    }
+
+    const sMemfaultRleWriteInfo *write_info = &rle_ctx->write_info;
+    if (!write_info->available) {
+      continue;
+    }
+
+    const uint32_t seq_size = write_info->header_len + write_info->write_len;
+    if ((encoded_size + seq_size) > max_encoded_size) {
+      // a run of literal bytes can be cut short to fill whatever space is left
+      if (write_info->write_len > 1) {
+        encoded_size += prv_rle_write_partial_literal_seq(
+          &data[write_info->write_start_offset], max_encoded_size - encoded_size, write_ctx);
+      }
+      *complete_out = false;
+      break;
+    }
+    if ((write_ctx != NULL) &&
+        (!prv_platform_coredump_write(write_info->header, write_info->header_len, write_ctx) ||
+         !prv_platform_coredump_write(&data[write_info->write_start_offset], write_info->write_len,
+                                      write_ctx))) {
+      break;
+    }
+    encoded_size += seq_size;
+  }
+
+  return encoded_size;
+}
+
+//! @return the size of the payload for a run length encoded block holding the region
+static uint32_t prv_rle_block_payload_size(const void *data, size_t data_len) {
+  bool complete;
+  return sizeof(sMfltCoredumpRleBlockHeader) +
+         prv_rle_encode_region(data, data_len, UINT32_MAX, NULL, &complete);
+}
+
+//! Write a region as a kMfltCoredumpRegionType_MemoryRegionRle block
+//!
+//! @param block_payload_size The size of the block payload, the region is truncated if it does
+//!  not encode into this
+static bool prv_write_rle_block(const void *data, size_t data_len, uint32_t address,
+                                size_t block_payload_size, sMfltCoredumpWriteCtx *write_ctx) {
+  const sMfltCoredumpBlock blk = {
+    .block_type = kMfltCoredumpRegionType_MemoryRegionRle,
+    .address = address,
+    .length = block_payload_size,
+  };
+  const sMfltCoredumpRleBlockHeader rle_hdr = {
+    .decoded_size = data_len,
+  };
+  if (!prv_platform_coredump_write(&blk, sizeof(blk), write_ctx) ||
+      !prv_platform_coredump_write(&rle_hdr, sizeof(rle_hdr), write_ctx)) {
+    return false;
+  }
+
+  const uint32_t max_encoded_size = block_payload_size - sizeof(rle_hdr);
+  bool complete;
+  const uint32_t encoded_size =
+    prv_rle_encode_region(data, data_len, max_encoded_size, write_ctx, &complete);
+  if (write_ctx->write_error) {
+    return false;
+  }
+
+  const uint32_t zero = 0;
+  uint32_t padding_needed = max_encoded_size - encoded_size;
+  while (padding_needed > 0) {
+    const uint32_t pad_size = MEMFAULT_MIN(padding_needed, sizeof(zero));
+    if (!prv_platform_coredump_write(&zero, pad_size, write_ctx)) {
+      return false;
+    }
+    padding_needed -= pad_size;
+  }
+
+  // the block itself was written, only record that the region didn't fit in it
+  if (!complete) {
+    write_ctx->truncated = true;
+  }
+  return true;
+}
+
+#endif /* MEMFAULT_COREDUMP_COMPRESS_REGIONS */
+
 static bool prv_write_block_with_address(eMfltCoredumpBlockType block_type,
                                          const void *block_payload, size_t block_payload_size,
                                          uint32_t address, sMfltCoredumpWriteCtx *write_ctx,
@@ -182,6 +575,23 @@ static bool prv_write_block_with_address(eMfltCoredumpBlockType block_type,
   const size_t storage_bytes_free =
     write_ctx->storage_size > write_ctx->offset ? write_ctx->storage_size - write_ctx->offset : 0;
 
+#if MEMFAULT_COREDUMP_COMPRESS_REGIONS
+  // Regions are only compressed when actually saving so computed sizes remain a worst case bound.
+  // Word access only regions are usually peripheral registers so are left alone. A RAM snapshot
+  // is left uncompressed to keep the fault handler fast and is compressed when committed instead.
+  if (!write_ctx->compute_size_only && !write_ctx->to_ram_snapshot &&
+      (block_type == kMfltCoredumpBlockType_MemoryRegion) && !word_aligned_reads_only) {
+    const size_t rle_payload_size = prv_rle_block_payload_size(block_payload, block_payload_size);
+    const size_t min_rle_block_size =
+      sizeof(sMfltCoredumpBlock) + sizeof(sMfltCoredumpRleBlockHeader) + 1;
+    if ((rle_payload_size < block_payload_size) && (storage_bytes_free >= min_rle_block_size)) {
+      const size_t rle_payload_size_max = storage_bytes_free - sizeof(sMfltCoredumpBlock);
+      return prv_write_rle_block(block_payload, block_payload_size, address,
+                                 MEMFAULT_MIN(rle_payload_size, rle_payload_size_max), write_ctx);
+    }
+  }
+#endif
+
   if (!write_ctx->compute_size_only && storage_bytes_free < total_length) {
     // We are trying to write a new block in the coredump and there is not enough
     // space. Let's see if we can truncate the block to fit in the space that is left
@@ -214,7 +624,9 @@ static bool prv_write_block_with_address(eMfltCoredumpBlockType block_type,
 
   // We have a region that needs to be read 32 bits at a time.
   //
-  // Typically these are very small regions such as a memory mapped register address
+  // Typically these are very small regions such as a memory mapped register address. When
+  // MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE is enabled, the words are staged in the write buffer
+  // rather than resulting in one storage write each.
   const uint32_t *word_data = block_payload;
   for (uint32_t i = 0; i < block_payload_size / 4; i++) {
     const uint32_t data = word_data[i];
@@ -223,7 +635,9 @@ static bool prv_write_block_with_address(eMfltCoredumpBlockType block_type,
     }
   }
 
-  return !write_ctx->truncated;
+  // A truncated block was still written successfully. write_ctx->truncated only records that the
+  // coredump is incomplete, so regions after a planned cut are still saved.
+  return true;
 }
 
 static bool prv_write_non_memory_block(eMfltCoredumpBlockType block_type, const void *block_payload,
@@ -233,6 +647,28 @@ static bool prv_write_non_memory_block(eMfltCoredumpBlockType block_type, const
                                       word_aligned_reads_only);
 }
 
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+//! Write a CRC32 block covering everything written since the last one. Skipped if there is no
+//! room left, in which case the final CRC32 block (which always has space set aside) covers it.
+//! Always counted when only computing the size, since there is no storage size to check against.
+static bool prv_write_crc_block(sMfltCoredumpWriteCtx *write_ctx) {
+  const size_t storage_bytes_free =
+    write_ctx->storage_size > write_ctx->offset ? write_ctx->storage_size - write_ctx->offset : 0;
+  if ((write_ctx->offset == write_ctx->crc_start_offset) ||
+      (!write_ctx->compute_size_only && (storage_bytes_free < MEMFAULT_COREDUMP_CRC_BLOCK_SIZE))) {
+    return true;
+  }
+
+  const uint32_t crc = write_ctx->crc;
+  if (!prv_write_non_memory_block(kMfltCoredumpRegionType_Crc32, &crc, sizeof(crc), write_ctx)) {
+    return false;
+  }
+  write_ctx->crc = MEMFAULT_CRC32_INITIAL_VALUE;
+  write_ctx->crc_start_offset = write_ctx->offset;
+  return true;
+}
+#endif /* MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED */
+
 static eMfltCoredumpBlockType prv_region_type_to_storage_type(eMfltCoredumpRegionType type) {
   switch (type) {
     case kMfltCoredumpRegionType_ArmV6orV7MpuUnrolled:
@@ -368,16 +804,32 @@ static void prv_insert_padding_if_necessary(sMfltCoredumpWriteCtx *write_ctx) {
 //! Callback that will be called to write coredump data.
 typedef bool (*MfltCoredumpReadCb)(uint32_t offset, void *data, size_t read_len);
 
-static bool prv_get_info_and_header(sMfltCoredumpHeader *hdr_out,
-                                    sMfltCoredumpStorageInfo *info_out,
-                                    MfltCoredumpReadCb coredump_read_cb) {
+//! Populate info with the coredump storage info, with the size reduced to that of a single slot
+static void prv_get_slot_info(sMfltCoredumpStorageInfo *info) {
+  memfault_platform_coredump_storage_get_info(info);
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+  // slots must start on a sector boundary so they can be erased independently
+  const size_t slot_size = info->size / MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS;
+  info->size = (info->sector_size != 0) ? MEMFAULT_FLOOR(slot_size, info->sector_size) : slot_size;
+#endif
+}
+
+size_t memfault_coredump_get_slot_size(void) {
   sMfltCoredumpStorageInfo info = { 0 };
-  memfault_platform_coredump_storage_get_info(&info);
+  prv_get_slot_info(&info);
+  return info.size;
+}
+
+static bool prv_get_info_and_header_for_slot(uint32_t slot, sMfltCoredumpHeader *hdr_out,
+                                             sMfltCoredumpStorageInfo *info_out,
+                                             MfltCoredumpReadCb coredump_read_cb) {
+  sMfltCoredumpStorageInfo info = { 0 };
+  prv_get_slot_info(&info);
   if (info.size == 0) {
     return false;  // no space for core files!
   }
 
-  if (!coredump_read_cb(0, hdr_out, sizeof(*hdr_out))) {
+  if (!coredump_read_cb(slot * info.size, hdr_out, sizeof(*hdr_out))) {
     // NB: This path is sometimes _expected_. For situations where
     // memfault_platform_coredump_storage_clear() is an asynchronous operation a caller may return
     // false for from memfault_coredump_read() to prevent any access to the coredump storage area.
@@ -390,17 +842,207 @@ static bool prv_get_info_and_header(sMfltCoredumpHeader *hdr_out,
   return true;
 }
 
-static bool prv_coredump_get_header(sMfltCoredumpHeader *hdr_out,
-                                    MfltCoredumpReadCb coredump_read_cb) {
-  return prv_get_info_and_header(hdr_out, NULL, coredump_read_cb);
-}
-
 static bool prv_coredump_header_is_valid(const sMfltCoredumpHeader *hdr) {
   return (hdr && hdr->magic == MEMFAULT_COREDUMP_MAGIC);
 }
 
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+
+static void prv_slot_dir_populate(MfltCoredumpReadCb coredump_read_cb) {
+  uint32_t used_mask = 0;
+  for (uint32_t slot = 0; slot < MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS; slot++) {
+    sMfltCoredumpHeader hdr = { 0 };
+    if (!prv_get_info_and_header_for_slot(slot, &hdr, NULL, coredump_read_cb)) {
+      // storage can't be read right now (i.e an asynchronous clear), try again on the next call
+      return;
+    }
+    if (prv_coredump_header_is_valid(&hdr)) {
+      used_mask |= (1UL << slot);
+    }
+  }
+  s_mflt_coredump_slot_dir.used_mask = used_mask;
+  s_mflt_coredump_slot_dir.populated = true;
+}
+
+//! @return the lowest slot set in mask
+static uint32_t prv_lowest_slot(uint32_t mask) {
+  // isolate the lowest set bit and convert it to an index
+  const uint32_t lowest_bit = mask & (~mask + 1);
+  return 31 - MEMFAULT_CLZ(lowest_bit);
+}
+
+//! Find the slot a new coredump should be saved to
+//!
+//! @return true if a free slot was found, false if every slot holds a coredump which has not been
+//!  drained yet
+static bool prv_find_free_slot(uint32_t *slot_out, MfltCoredumpReadCb coredump_read_cb) {
+  if (!s_mflt_coredump_slot_dir.populated) {
+    // only expected if we crash before coredump storage was ever polled this boot
+    prv_slot_dir_populate(coredump_read_cb);
+  }
+
+  const uint32_t all_slots_mask = (MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS == 32) ?
+                                    UINT32_MAX :
+                                    ((1UL << MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS) - 1);
+  uint32_t free_mask = ~s_mflt_coredump_slot_dir.used_mask & all_slots_mask;
+  while (free_mask != 0) {
+    const uint32_t slot = prv_lowest_slot(free_mask);
+
+    // confirm the slot really is free in case storage was written behind our back
+    sMfltCoredumpHeader hdr = { 0 };
+    if (!prv_get_info_and_header_for_slot(slot, &hdr, NULL, coredump_read_cb)) {
+      return false;
+    }
+    if (!prv_coredump_header_is_valid(&hdr)) {
+      *slot_out = slot;
+      return true;
+    }
+
+    s_mflt_coredump_slot_dir.used_mask |= (1UL << slot);
+    free_mask &= ~(1UL << slot);
+  }
+  return false;
+}
+
+#endif /* MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1 */
+
+//! A group of regions to save (i.e the arch, sdk, or platform regions)
+typedef struct {
+  const sMfltCoredumpRegion *regions;
+  size_t num_regions;
+} sMfltCoredumpRegionList;
+
+#if MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED
+
+//! The number of bytes of each region to save, indexed by the position of the region across all
+//! region lists. Populated by prv_plan_region_sizes() prior to writing any regions.
+static uint32_t s_mflt_coredump_planned_sizes[MEMFAULT_COREDUMP_REGION_PLANNER_MAX_REGIONS];
+
+//! @return the storage needed to save size bytes of a region, including the block header and the
+//!   padding block which is needed before the next region when size is not word aligned
+static uint32_t prv_region_storage_cost(uint32_t size) {
+  if (size == 0) {
+    return 0;
+  }
+
+  uint32_t cost = sizeof(sMfltCoredumpBlock) + size;
+  if ((size % 4) != 0) {
+    cost += sizeof(sMfltCoredumpBlock) + (4 - (size % 4));
+  }
+  return cost;
+}
+
+//! Grow the planned size for a region towards desired_size, truncating to a word multiple if the
+//! budget remaining can't hold all of it
+static uint32_t prv_grow_planned_size(uint32_t planned_size, uint32_t desired_size,
+                                      uint32_t *budget) {
+  if (desired_size <= planned_size) {
+    return planned_size;
+  }
+
+  // the budget available to this region, including what it has already been allocated
+  const uint32_t available = *budget + prv_region_storage_cost(planned_size);
+  uint32_t new_size = desired_size;
+  if (prv_region_storage_cost(new_size) > available) {
+    if (available <= sizeof(sMfltCoredumpBlock)) {
+      return planned_size;
+    }
+    new_size = MEMFAULT_FLOOR(available - sizeof(sMfltCoredumpBlock), 4);
+    if (new_size <= planned_size) {
+      return planned_size;
+    }
+  }
+
+  *budget = available - prv_region_storage_cost(new_size);
+  return new_size;
+}
+
+//! Compute the size of a region after any cached block fixups have been applied
+static uint32_t prv_region_save_size(const sMfltCoredumpRegion *region) {
+  sMfltCoredumpRegion region_copy = *region;
+  uint32_t address = (uint32_t)(uintptr_t)region_copy.region_start;
+  if (!prv_fixup_if_cached_block(&region_copy, &address) || (region_copy.region_start == NULL)) {
+    return 0;
+  }
+  const bool scan_stack = true;
+  prv_fixup_if_thread_stack(&region_copy, &address, scan_stack);
+  return region_copy.region_size;
+}
+
+//! Budget the storage space left after write_ctx->offset across all regions
+//!
+//! Each region is first allocated up to its guaranteed_size in priority order, and then up to its
+//! full size in priority order. Regions with equal priority are allocated in the order they
+//! would be written.
+static void prv_plan_region_sizes(const sMfltCoredumpWriteCtx *write_ctx,
+                                  const sMfltCoredumpRegionList *lists, size_t num_lists) {
+  memset(s_mflt_coredump_planned_sizes, 0x0, sizeof(s_mflt_coredump_planned_sizes));
+
+  // the first region may need a padding block to start on a word boundary
+  uint32_t start_offset = write_ctx->offset;
+  if ((start_offset % 4) != 0) {
+    start_offset += sizeof(sMfltCoredumpBlock) + (4 - (start_offset % 4));
+  }
+  uint32_t budget =
+    (write_ctx->storage_size > start_offset) ? write_ctx->storage_size - start_offset : 0;
+
+  // set aside space for the blocks saved alongside regions
+  const uint32_t thread_stack_info_cost =
+    sizeof(sMfltCoredumpBlock) + sizeof(sMfltThreadStackInfoBlock);
+  for (size_t i = 0; i < num_lists; i++) {
+    for (size_t j = 0; j < lists[i].num_regions; j++) {
+      uint32_t cost = MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED ? MEMFAULT_COREDUMP_CRC_BLOCK_SIZE : 0;
+      if (lists[i].regions[j].type == kMfltCoredumpRegionType_ThreadStack) {
+        cost += thread_stack_info_cost;
+      }
+      budget = (budget > cost) ? budget - cost : 0;
+    }
+  }
+
+  for (int pass = 0; pass < 2; pass++) {
+    const bool guaranteed_pass = (pass == 0);
+    uint32_t curr_priority = 0;
+    while (1) {
+      uint32_t next_priority = UINT32_MAX;
+      size_t idx = 0;
+      for (size_t i = 0; i < num_lists; i++) {
+        for (size_t j = 0; j < lists[i].num_regions; j++, idx++) {
+          if (idx >= MEMFAULT_COREDUMP_REGION_PLANNER_MAX_REGIONS) {
+            break;
+          }
+          const sMfltCoredumpRegion *region = &lists[i].regions[j];
+          if (region->priority != curr_priority) {
+            if (region->priority > curr_priority) {
+              next_priority = MEMFAULT_MIN(next_priority, region->priority);
+            }
+            continue;
+          }
+
+          const uint32_t region_size = prv_region_save_size(region);
+          const uint32_t desired_size =
+            guaranteed_pass ? MEMFAULT_MIN(region->guaranteed_size, region_size) : region_size;
+          s_mflt_coredump_planned_sizes[idx] =
+            prv_grow_planned_size(s_mflt_coredump_planned_sizes[idx], desired_size, &budget);
+        }
+      }
+
+      if (next_priority == UINT32_MAX) {
+        break;
+      }
+      curr_priority = next_priority;
+    }
+  }
+}
+
+#endif /* MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED */
+
+//! Write out a list of regions
+//!
+//! @param planned_sizes When non-NULL, the number of bytes of each region to save
+//! @param num_planned_sizes The number of entries in planned_sizes
 static bool prv_write_regions(sMfltCoredumpWriteCtx *write_ctx, const sMfltCoredumpRegion *regions,
-                              size_t num_regions) {
+                              size_t num_regions, const uint32_t *planned_sizes,
+                              size_t num_planned_sizes) {
   for (size_t i = 0; i < num_regions; i++) {
     prv_insert_padding_if_necessary(write_ctx);
 
@@ -413,6 +1055,51 @@ static bool prv_write_regions(sMfltCoredumpWriteCtx *write_ctx, const sMfltCored
       // We must skip invalid cached blocks.
       continue;
     }
+    const bool scan_stack = !write_ctx->compute_size_only;
+    const bool thread_stack = prv_fixup_if_thread_stack(&region_copy, &address, scan_stack);
+    const uint32_t stack_used = region_copy.region_size;
+
+    if (planned_sizes != NULL) {
+      const uint32_t planned_size = (i < num_planned_sizes) ? planned_sizes[i] : 0;
+      if (planned_size < region_copy.region_size) {
+        write_ctx->truncated = true;
+        prv_trim_region(&region_copy, &address, planned_size, thread_stack);
+      }
+      if (region_copy.region_size == 0) {
+        continue;
+      }
+    }
+
+    if (thread_stack && (region_copy.region_start != NULL)) {
+      // prv_write_block_with_address() keeps the start of a region which doesn't fit in the space
+      // left, so trim a thread stack from the bottom here instead
+      const uint32_t blocks_size =
+        2 * sizeof(sMfltCoredumpBlock) + sizeof(sMfltThreadStackInfoBlock);
+      const size_t storage_bytes_free = write_ctx->storage_size > write_ctx->offset ?
+                                          write_ctx->storage_size - write_ctx->offset :
+                                          0;
+      if (!write_ctx->compute_size_only &&
+          (storage_bytes_free < (blocks_size + region_copy.region_size))) {
+        write_ctx->truncated = true;
+        const uint32_t fits = (storage_bytes_free > blocks_size) ?
+                                MEMFAULT_FLOOR(storage_bytes_free - blocks_size, 4) :
+                                0;
+        prv_trim_region(&region_copy, &address, fits, thread_stack);
+        if (region_copy.region_size == 0) {
+          continue;
+        }
+      }
+
+      const sMfltThreadStackInfoBlock stack_info = {
+        .stack_base = (uint32_t)(uintptr_t)regions[i].region_start,
+        .stack_size = regions[i].region_size,
+        .high_water_mark = stack_used,
+      };
+      if (!prv_write_non_memory_block(kMfltCoredumpRegionType_ThreadStackInfo, &stack_info,
+                                      sizeof(stack_info), write_ctx)) {
+        return false;
+      }
+    }
 
     const bool word_aligned_reads_only =
       (region_copy.type == kMfltCoredumpRegionType_MemoryWordAccessOnly);
@@ -422,75 +1109,81 @@ static bool prv_write_regions(sMfltCoredumpWriteCtx *write_ctx, const sMfltCored
                                       write_ctx, word_aligned_reads_only)) {
       return false;
     }
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+    if (!prv_write_crc_block(write_ctx)) {
+      return false;
+    }
+#endif
   }
   return true;
 }
 
-static bool prv_write_coredump_sections(const sMemfaultCoredumpSaveInfo *save_info,
-                                        bool compute_size_only, size_t *total_size) {
-  sMfltCoredumpStorageInfo info = { 0 };
-  sMfltCoredumpHeader hdr = { 0 };
-
-  // are there some regions for us to save?
-  size_t num_regions = save_info->num_regions;
-  const sMfltCoredumpRegion *regions = save_info->regions;
-  if ((regions == NULL) || (num_regions == 0)) {
-    // sanity check that we got something valid from the caller
-    return false;
+//! Erase storage up front or configure the write context to erase it as the coredump is written
+//!
+//! @param info Storage info for the slot being written (see prv_get_slot_info())
+static bool prv_prepare_storage_for_save(const sMfltCoredumpStorageInfo *info,
+                                         sMfltCoredumpWriteCtx *write_ctx) {
+#if MEMFAULT_COREDUMP_STORAGE_ERASE_LAZY || MEMFAULT_COREDUMP_STORAGE_PRE_ERASE
+  // with no sector size available, the whole slot is treated as one sector
+  write_ctx->erase_lazily = true;
+  write_ctx->sector_size = (info->sector_size != 0) ? info->sector_size : info->size;
+  write_ctx->erase_limit = info->size;
+  write_ctx->erased_offset = 0;
+  #if MEMFAULT_COREDUMP_STORAGE_PRE_ERASE
+  // any sectors erased in the background don't need to be erased again
+  if (s_mflt_coredump_pre_erase_complete) {
+    write_ctx->erased_offset = info->size;
+  } else if (s_mflt_coredump_pre_erased_offset > write_ctx->slot_base) {
+    write_ctx->erased_offset =
+      MEMFAULT_MIN(s_mflt_coredump_pre_erased_offset - write_ctx->slot_base, info->size);
   }
-
-  if (!compute_size_only) {
-    if (!memfault_platform_coredump_save_begin()) {
+  #endif
+  #if !MEMFAULT_COREDUMP_STORAGE_ERASE_LAZY
+  if (write_ctx->erased_offset < info->size) {
+    // pre-erase didn't finish so fall back to erasing everything that remains
+    if (!memfault_platform_coredump_storage_erase(write_ctx->slot_base + write_ctx->erased_offset,
+                                                  info->size - write_ctx->erased_offset)) {
       return false;
     }
-
-    // If we are saving a new coredump but one is already stored, don't overwrite it. This way
-    // the first issue which started the crash loop can be determined
-    MfltCoredumpReadCb coredump_read_cb = memfault_platform_coredump_storage_read;
-    if (!prv_get_info_and_header(&hdr, &info, coredump_read_cb)) {
-      return false;
-    }
-
-    if (prv_coredump_header_is_valid(&hdr)) {
-      return false;  // don't overwrite what we got!
-    }
-  }
-
-  // erase storage provided we aren't just computing the size
-  if (!compute_size_only && !memfault_platform_coredump_storage_erase(0, info.size)) {
-    return false;
+    write_ctx->erased_offset = info->size;
   }
+  #endif
+  return true;
+#else
+  return memfault_platform_coredump_storage_erase(write_ctx->slot_base, info->size);
+#endif
+}
 
-  sMfltCoredumpWriteCtx write_ctx = {
-    // We will write the header last as a way to mark validity
-    // so advance the offset past it to start
-    .offset = sizeof(hdr),
-    .compute_size_only = compute_size_only,
-    .storage_size = info.size,
-  };
+//! Writes the blocks which make up the body of a coredump
+//!
+//! @return false if the coredump should be abandoned
+typedef bool (*MfltCoredumpWriteBlocksCb)(sMfltCoredumpWriteCtx *write_ctx, const void *ctx);
 
-  if (write_ctx.storage_size > sizeof(sMfltCoredumpFooter)) {
-    // always leave space for footer
-    write_ctx.storage_size -= sizeof(sMfltCoredumpFooter);
-  }
+static bool prv_write_save_info_blocks(sMfltCoredumpWriteCtx *write_ctx, const void *ctx) {
+  const sMemfaultCoredumpSaveInfo *save_info = ctx;
 
   const void *regs = save_info->regs;
   const size_t regs_size = save_info->regs_size;
   if (regs != NULL) {
     if (!prv_write_non_memory_block(kMfltCoredumpBlockType_CurrentRegisters, regs, regs_size,
-                                    &write_ctx)) {
+                                    write_ctx)) {
       return false;
     }
   }
 
-  if (!prv_write_device_info_blocks(&write_ctx)) {
+  if (!prv_write_device_info_blocks(write_ctx)) {
     return false;
   }
 
   const uint32_t trace_reason = save_info->trace_reason;
-  if (!prv_write_trace_reason(&write_ctx, trace_reason)) {
+  if (!prv_write_trace_reason(write_ctx, trace_reason)) {
+    return false;
+  }
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+  if (!prv_write_crc_block(write_ctx)) {
     return false;
   }
+#endif
 
   // write out any architecture specific regions
   size_t num_arch_regions = 0;
@@ -498,33 +1191,179 @@ static bool prv_write_coredump_sections(const sMemfaultCoredumpSaveInfo *save_in
   size_t num_sdk_regions = 0;
   const sMfltCoredumpRegion *sdk_regions = memfault_coredump_get_sdk_regions(&num_sdk_regions);
 
-  const bool write_completed = prv_write_regions(&write_ctx, arch_regions, num_arch_regions) &&
-                               prv_write_regions(&write_ctx, sdk_regions, num_sdk_regions) &&
-                               prv_write_regions(&write_ctx, regions, num_regions);
+  const sMfltCoredumpRegionList region_lists[] = {
+    { .regions = arch_regions, .num_regions = num_arch_regions },
+    { .regions = sdk_regions, .num_regions = num_sdk_regions },
+    { .regions = save_info->regions, .num_regions = save_info->num_regions },
+  };
+
+  const uint32_t *planned_sizes = NULL;
+  size_t num_planned_sizes = 0;
+#if MEMFAULT_COREDUMP_REGION_PLANNER_ENABLED
+  if (!write_ctx->compute_size_only) {
+    prv_plan_region_sizes(write_ctx, region_lists, MEMFAULT_ARRAY_SIZE(region_lists));
+    planned_sizes = s_mflt_coredump_planned_sizes;
+    num_planned_sizes = MEMFAULT_ARRAY_SIZE(s_mflt_coredump_planned_sizes);
+  }
+#endif
+
+  bool write_completed = true;
+  for (size_t i = 0; write_completed && (i < MEMFAULT_ARRAY_SIZE(region_lists)); i++) {
+    write_completed = prv_write_regions(write_ctx, region_lists[i].regions,
+                                        region_lists[i].num_regions, planned_sizes,
+                                        num_planned_sizes);
+    if (planned_sizes != NULL) {
+      const size_t consumed = MEMFAULT_MIN(region_lists[i].num_regions, num_planned_sizes);
+      planned_sizes += consumed;
+      num_planned_sizes -= consumed;
+    }
+  }
+
+  // a truncated region still leaves a coredump worth keeping
+  return write_completed || !write_ctx->write_error;
+}
 
-  if (!write_completed && write_ctx.write_error) {
+//! Find the space a new coredump will be written to and check it isn't holding one already
+//!
+//! @param info Populated with the size of the space available
+//! @param slot_out Populated with the coredump storage slot to write to
+static bool prv_find_space_for_save(bool to_ram_snapshot, MfltCoredumpReadCb coredump_read_cb,
+                                    sMfltCoredumpStorageInfo *info, uint32_t *slot_out) {
+  sMfltCoredumpHeader hdr = { 0 };
+  *slot_out = 0;
+#if MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0
+  if (to_ram_snapshot) {
+    *info = (sMfltCoredumpStorageInfo){ .size = sizeof(s_mflt_coredump_snapshot) };
+    memcpy(&hdr, s_mflt_coredump_snapshot, sizeof(hdr));
+    return !prv_coredump_header_is_valid(&hdr);
+  }
+#else
+  (void)to_ram_snapshot;
+#endif
+
+  // If we are saving a new coredump but one is already stored, don't overwrite it. This way
+  // the first issue which started the crash loop can be determined
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+  if (!prv_find_free_slot(slot_out, coredump_read_cb)) {
+    return false;  // every slot is holding a coredump which hasn't been drained yet
+  }
+#endif
+  if (!prv_get_info_and_header_for_slot(*slot_out, &hdr, info, coredump_read_cb)) {
+    return false;
+  }
+
+  return !prv_coredump_header_is_valid(&hdr);  // don't overwrite what we got!
+}
+
+//! Write a complete coredump: the blocks from write_blocks_cb followed by the final CRC32
+//! block and footer and, last of all, the header which marks the coredump valid
+//!
+//! @param to_ram_snapshot Write to the RAM snapshot rather than coredump storage
+//! @param coredump_read_cb Used to check whether coredump storage already holds a coredump
+static bool prv_write_coredump(bool compute_size_only, bool to_ram_snapshot,
+                               MfltCoredumpReadCb coredump_read_cb,
+                               MfltCoredumpWriteBlocksCb write_blocks_cb, const void *cb_ctx,
+                               size_t *total_size) {
+  sMfltCoredumpStorageInfo info = { 0 };
+  uint32_t slot = 0;
+
+  if (!compute_size_only &&
+      !prv_find_space_for_save(to_ram_snapshot, coredump_read_cb, &info, &slot)) {
+    return false;
+  }
+
+  sMfltCoredumpWriteCtx write_ctx = {
+    // We will write the header last as a way to mark validity
+    // so advance the offset past it to start
+    .offset = sizeof(sMfltCoredumpHeader),
+    .compute_size_only = compute_size_only,
+    .storage_size = info.size,
+    .slot_base = slot * info.size,
+    .to_ram_snapshot = to_ram_snapshot,
+  };
+
+  // erase storage provided we aren't just computing the size. RAM needs no erasing.
+  if (!compute_size_only && !to_ram_snapshot &&
+      !prv_prepare_storage_for_save(&info, &write_ctx)) {
     return false;
   }
+#if MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE > 0
+  s_mflt_coredump_write_buf.start_offset = write_ctx.offset;
+  s_mflt_coredump_write_buf.len = 0;
+#endif
+
+  if (write_ctx.storage_size > sizeof(sMfltCoredumpFooter)) {
+    // always leave space for footer
+    write_ctx.storage_size -= sizeof(sMfltCoredumpFooter);
+  }
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+  // and for the final CRC32 block
+  const size_t crc_block_space =
+    (write_ctx.storage_size > MEMFAULT_COREDUMP_CRC_BLOCK_SIZE) ? MEMFAULT_COREDUMP_CRC_BLOCK_SIZE :
+                                                                  0;
+  write_ctx.storage_size -= crc_block_space;
+  write_ctx.crc = MEMFAULT_CRC32_INITIAL_VALUE;
+  write_ctx.crc_start_offset = write_ctx.offset;
+#endif
+
+  if (!write_blocks_cb(&write_ctx, cb_ctx)) {
+    return false;
+  }
+
+  uint32_t footer_flags = write_ctx.truncated ? (1 << kMfltCoredumpBlockType_SaveTruncated) : 0;
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+  write_ctx.storage_size += crc_block_space;
+  if (!prv_write_crc_block(&write_ctx)) {
+    return false;
+  }
+  footer_flags |= (1 << kMfltCoredumpBlockType_BlockCrc32);
+#endif
 
   const sMfltCoredumpFooter footer = (sMfltCoredumpFooter){
     .magic = MEMFAULT_COREDUMP_FOOTER_MAGIC,
-    .flags = write_ctx.truncated ? (1 << kMfltCoredumpBlockType_SaveTruncated) : 0,
+    .flags = footer_flags,
   };
   write_ctx.storage_size = info.size;
-  if (!prv_platform_coredump_write(&footer, sizeof(footer), &write_ctx)) {
+  if (!prv_platform_coredump_write(&footer, sizeof(footer), &write_ctx) ||
+      !prv_platform_coredump_write_flush(&write_ctx)) {
     return false;
   }
 
   const size_t end_offset = write_ctx.offset;
   write_ctx.offset = 0;  // we are writing the header so reset our write offset
-  const bool success = prv_write_coredump_header(end_offset, &write_ctx);
+  const bool success = prv_write_coredump_header(end_offset, &write_ctx) &&
+                       prv_platform_coredump_write_flush(&write_ctx);
   if (success) {
     *total_size = end_offset;
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+    if (!compute_size_only && !to_ram_snapshot) {
+      s_mflt_coredump_slot_dir.used_mask |= (1UL << slot);
+    }
+#endif
   }
 
   return success;
 }
 
+static bool prv_write_coredump_sections(const sMemfaultCoredumpSaveInfo *save_info,
+                                        bool compute_size_only, size_t *total_size) {
+  // are there some regions for us to save?
+  if ((save_info->regions == NULL) || (save_info->num_regions == 0)) {
+    // sanity check that we got something valid from the caller
+    return false;
+  }
+
+  // From the fault handler, either snapshot to RAM or write to coredump storage directly
+  const bool to_ram_snapshot = (MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0);
+  if (!compute_size_only && !to_ram_snapshot && !memfault_platform_coredump_save_begin()) {
+    return false;
+  }
+
+  return prv_write_coredump(compute_size_only, to_ram_snapshot,
+                            memfault_platform_coredump_storage_read, prv_write_save_info_blocks,
+                            save_info, total_size);
+}
+
 MEMFAULT_WEAK bool memfault_platform_coredump_save_begin(void) {
   return true;
 }
@@ -537,6 +1376,10 @@ size_t memfault_coredump_get_save_size(const sMemfaultCoredumpSaveInfo *save_inf
 }
 
 bool memfault_coredump_save(const sMemfaultCoredumpSaveInfo *save_info) {
+#if MEMFAULT_COREDUMP_COLLECT_LOG_REGIONS
+  // capture the logs that were saved lock-free but not moved to the log buffer yet
+  memfault_log_flush_pending_nolock();
+#endif
   const bool compute_size_only = false;
   size_t total_size = 0;
   return prv_write_coredump_sections(save_info, compute_size_only, &total_size);
@@ -547,7 +1390,31 @@ bool memfault_coredump_has_valid_coredump(size_t *total_size_out) {
   // This routine is only called while the system is running so _always_ use the
   // memfault_coredump_read, which is safe to call while the system is running
   MfltCoredumpReadCb coredump_read_cb = memfault_coredump_read;
-  if (!prv_coredump_get_header(&hdr, coredump_read_cb)) {
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+  // The slot directory is read from storage once and then kept up to date as coredumps are saved
+  // and drained, so a poll only reads the header of the slot which will be drained next. A slot
+  // cleared outside of the SDK is dropped from the directory when its header is checked.
+  if (!s_mflt_coredump_slot_dir.populated) {
+    prv_slot_dir_populate(coredump_read_cb);
+  }
+  while (s_mflt_coredump_slot_dir.used_mask != 0) {
+    // drain the lowest slot first
+    const uint32_t slot = prv_lowest_slot(s_mflt_coredump_slot_dir.used_mask);
+    if (!prv_get_info_and_header_for_slot(slot, &hdr, NULL, coredump_read_cb)) {
+      return false;
+    }
+    if (prv_coredump_header_is_valid(&hdr)) {
+      s_mflt_coredump_slot_dir.read_slot = slot;
+      if (total_size_out) {
+        *total_size_out = hdr.total_size;
+      }
+      return true;
+    }
+    s_mflt_coredump_slot_dir.used_mask &= ~(1UL << slot);
+  }
+  return false;
+#else
+  if (!prv_get_info_and_header_for_slot(0, &hdr, NULL, coredump_read_cb)) {
     return false;
   }
   if (!prv_coredump_header_is_valid(&hdr)) {
@@ -557,15 +1424,429 @@ bool memfault_coredump_has_valid_coredump(size_t *total_size_out) {
     *total_size_out = hdr.total_size;
   }
   return true;
+#endif
+}
+
+#if MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0
+
+//! @return the size of the coredump held in the RAM snapshot or 0 if there isn't a valid one
+static size_t prv_snapshot_size(void) {
+  const uint8_t *snapshot = (const uint8_t *)s_mflt_coredump_snapshot;
+  sMfltCoredumpHeader hdr;
+  memcpy(&hdr, snapshot, sizeof(hdr));
+  // the buffer isn't initialized on boot so check everything the commit relies on
+  if (!prv_coredump_header_is_valid(&hdr) ||
+      (hdr.total_size < (sizeof(hdr) + sizeof(sMfltCoredumpFooter))) ||
+      (hdr.total_size > sizeof(s_mflt_coredump_snapshot))) {
+    return 0;
+  }
+
+  sMfltCoredumpFooter footer;
+  memcpy(&footer, &snapshot[hdr.total_size - sizeof(footer)], sizeof(footer));
+  return (footer.magic == MEMFAULT_COREDUMP_FOOTER_MAGIC) ? hdr.total_size : 0;
+}
+
+//! Copy the blocks held in the RAM snapshot to the coredump being written
+//!
+//! @param ctx The size of the coredump held in the RAM snapshot
+static bool prv_write_snapshot_blocks(sMfltCoredumpWriteCtx *write_ctx, const void *ctx) {
+  const uint8_t *snapshot = (const uint8_t *)s_mflt_coredump_snapshot;
+  const size_t end_offset = *(const size_t *)ctx - sizeof(sMfltCoredumpFooter);
+  sMfltCoredumpFooter footer;
+  memcpy(&footer, &snapshot[end_offset], sizeof(footer));
+  const bool snapshot_truncated = (footer.flags & (1 << kMfltCoredumpBlockType_SaveTruncated));
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+  size_t crc_start_offset = sizeof(sMfltCoredumpHeader);
+#endif
+
+  size_t offset = sizeof(sMfltCoredumpHeader);
+  bool write_completed = true;
+  while (write_completed && ((end_offset - offset) >= sizeof(sMfltCoredumpBlock))) {
+    sMfltCoredumpBlock blk;
+    memcpy(&blk, &snapshot[offset], sizeof(blk));
+    offset += sizeof(blk);
+    if (blk.length > (end_offset - offset)) {
+      return false;  // corrupt
+    }
+    const uint8_t *payload = &snapshot[offset];
+    offset += blk.length;
+
+    switch (blk.block_type) {
+      case kMfltCoredumpRegionType_PaddingRegion:
+        // alignment is recomputed for the blocks being written
+        continue;
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+      case kMfltCoredumpRegionType_Crc32: {
+        // check the retained RAM survived the reboot, then checksum the (possibly compressed)
+        // blocks written in its place
+        const size_t block_offset = offset - blk.length - sizeof(blk);
+        uint32_t crc;
+        memcpy(&crc, payload, sizeof(crc));
+        if ((blk.length != sizeof(crc)) ||
+            (memfault_crc32_compute(MEMFAULT_CRC32_INITIAL_VALUE, &snapshot[crc_start_offset],
+                                    block_offset - crc_start_offset) != crc)) {
+          return false;
+        }
+        crc_start_offset = offset;
+        if (!prv_write_crc_block(write_ctx)) {
+          return false;
+        }
+        continue;
+      }
+#endif
+      case kMfltCoredumpBlockType_MemoryRegion:
+        prv_insert_padding_if_necessary(write_ctx);
+        break;
+      default:
+        break;
+    }
+
+    const bool word_aligned_reads_only = false;
+    write_completed = prv_write_block_with_address(blk.block_type, payload, blk.length,
+                                                   blk.address, write_ctx,
+                                                   word_aligned_reads_only);
+  }
+
+  write_ctx->truncated |= snapshot_truncated;
+  // coredump storage filling up still leaves a coredump worth keeping
+  return write_completed || !write_ctx->write_error;
+}
+
+bool memfault_coredump_snapshot_pending(void) {
+  return prv_snapshot_size() != 0;
+}
+
+bool memfault_coredump_snapshot_commit(void) {
+  const size_t snapshot_size = prv_snapshot_size();
+  if (snapshot_size == 0) {
+    return false;
+  }
+
+  sMfltCoredumpStorageInfo info = { 0 };
+  uint32_t slot = 0;
+  MfltCoredumpReadCb coredump_read_cb = memfault_coredump_read;
+  const bool to_ram_snapshot = false;
+  if (!prv_find_space_for_save(to_ram_snapshot, coredump_read_cb, &info, &slot)) {
+    // storage is holding a coredump which hasn't been drained yet, keep the snapshot until later
+    return false;
+  }
+
+  const bool compute_size_only = false;
+  size_t total_size = 0;
+  const bool success =
+    prv_write_coredump(compute_size_only, to_ram_snapshot, coredump_read_cb,
+                       prv_write_snapshot_blocks, &snapshot_size, &total_size);
+  if (!success) {
+    MEMFAULT_LOG_ERROR("Coredump snapshot could not be committed, discarding");
+  }
+
+  // invalidate the header so the snapshot isn't committed again
+  s_mflt_coredump_snapshot[0] = 0;
+  return success;
+}
+
+#endif /* MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0 */
+
+#if MEMFAULT_COREDUMP_STORAGE_PRE_ERASE
+bool memfault_coredump_storage_pre_erase_step(void) {
+  if (s_mflt_coredump_pre_erase_complete) {
+    return true;
+  }
+
+  if (memfault_coredump_has_valid_coredump(NULL)) {
+    // don't erase a coredump which has not been drained yet
+    s_mflt_coredump_pre_erased_offset = 0;
+    return false;
+  }
+
+  sMfltCoredumpStorageInfo info = { 0 };
+  memfault_platform_coredump_storage_get_info(&info);
+  if (info.size == 0) {
+    return false;
+  }
+
+  const size_t sector_size = (info.sector_size != 0) ? info.sector_size : info.size;
+  const size_t erase_size =
+    MEMFAULT_MIN(sector_size, info.size - s_mflt_coredump_pre_erased_offset);
+  if (!memfault_platform_coredump_storage_erase(s_mflt_coredump_pre_erased_offset, erase_size)) {
+    return false;
+  }
+
+  s_mflt_coredump_pre_erased_offset += erase_size;
+  s_mflt_coredump_pre_erase_complete = (s_mflt_coredump_pre_erased_offset >= info.size);
+  return s_mflt_coredump_pre_erase_complete;
 }
 
+void memfault_coredump_storage_pre_erase_reset(void) {
+  s_mflt_coredump_pre_erased_offset = 0;
+  s_mflt_coredump_pre_erase_complete = false;
+}
+#endif /* MEMFAULT_COREDUMP_STORAGE_PRE_ERASE */
+
 MEMFAULT_WEAK bool memfault_coredump_read(uint32_t offset, void *buf, size_t buf_len) {
   return memfault_platform_coredump_storage_read(offset, buf, buf_len);
 }
 
+MEMFAULT_WEAK bool memfault_platform_coredump_storage_get_read_pointer(
+  MEMFAULT_UNUSED uint32_t offset, MEMFAULT_UNUSED const void **read_ptr,
+  MEMFAULT_UNUSED size_t *read_ptr_len) {
+  return false;
+}
+
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+MEMFAULT_WEAK void memfault_platform_coredump_storage_clear_slot(uint32_t slot_offset) {
+  sMfltCoredumpStorageInfo info = { 0 };
+  memfault_platform_coredump_storage_get_info(&info);
+  if ((info.sector_size != 0) &&
+      memfault_platform_coredump_storage_erase(slot_offset, info.sector_size)) {
+    return;
+  }
+  // Erases must be a whole sector, so without one zero out the magic of the header instead
+  const uint32_t zero = 0;
+  memfault_platform_coredump_storage_write(slot_offset, &zero, sizeof(zero));
+}
+
+#endif /* MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1 */
+
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+typedef struct {
+  bool started;
+  eMemfaultCoredumpVerifyResult result;
+  //! The coredump being checked
+  uint32_t slot;
+  uint32_t total_size;
+  //! The offset of the next byte to check
+  uint32_t offset;
+  //! The offset the block being checked ends at
+  uint32_t block_end;
+  //! The offset of the footer, where the blocks end
+  uint32_t footer_offset;
+  //! The CRC32 of everything checked since crc_start_offset
+  uint32_t crc;
+  uint32_t crc_start_offset;
+} sMfltCoredumpVerifyState;
+
+static sMfltCoredumpVerifyState s_mflt_coredump_verify;
+#endif
+
+//! Read from the coredump being drained by g_memfault_coredump_data_source
+static bool prv_coredump_read_active(uint32_t offset, void *buf, size_t buf_len) {
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+  const size_t slot_base = s_mflt_coredump_slot_dir.read_slot * memfault_coredump_get_slot_size();
+  return memfault_coredump_read(slot_base + offset, buf, buf_len);
+#else
+  return memfault_coredump_read(offset, buf, buf_len);
+#endif
+}
+
+static bool prv_coredump_get_read_pointer_active(uint32_t offset, const void **read_ptr,
+                                                 size_t *read_ptr_len) {
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+  const size_t slot_size = memfault_coredump_get_slot_size();
+  if (offset >= slot_size) {
+    return false;
+  }
+  const size_t slot_base = s_mflt_coredump_slot_dir.read_slot * slot_size;
+  if (!memfault_platform_coredump_storage_get_read_pointer(slot_base + offset, read_ptr,
+                                                           read_ptr_len)) {
+    return false;
+  }
+  // don't hand out bytes belonging to the next slot
+  *read_ptr_len = MEMFAULT_MIN(*read_ptr_len, slot_size - offset);
+  return true;
+#else
+  return memfault_platform_coredump_storage_get_read_pointer(offset, read_ptr, read_ptr_len);
+#endif
+}
+
+//! Clear the coredump being drained by g_memfault_coredump_data_source
+static void prv_coredump_clear_active(void) {
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+  s_mflt_coredump_verify = (sMfltCoredumpVerifyState){ 0 };
+#endif
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+  const uint32_t slot = s_mflt_coredump_slot_dir.read_slot;
+  memfault_platform_coredump_storage_clear_slot(slot * memfault_coredump_get_slot_size());
+  s_mflt_coredump_slot_dir.used_mask &= ~(1UL << slot);
+#else
+  memfault_platform_coredump_storage_clear();
+#endif
+}
+
+void memfault_coredump_storage_clear_all(void) {
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+  s_mflt_coredump_verify = (sMfltCoredumpVerifyState){ 0 };
+#endif
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+  const size_t slot_size = memfault_coredump_get_slot_size();
+  for (uint32_t slot = 0; slot < MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS; slot++) {
+    memfault_platform_coredump_storage_clear_slot(slot * slot_size);
+  }
+  s_mflt_coredump_slot_dir.used_mask = 0;
+#else
+  memfault_platform_coredump_storage_clear();
+#endif
+}
+
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+
+static void prv_verify_begin(sMfltCoredumpVerifyState *state, uint32_t slot, size_t total_size) {
+  *state = (sMfltCoredumpVerifyState){
+    .started = true,
+    .result = kMemfaultCoredumpVerifyResult_InProgress,
+    .slot = slot,
+    .total_size = total_size,
+    .offset = sizeof(sMfltCoredumpHeader),
+    .block_end = sizeof(sMfltCoredumpHeader),
+    .crc = MEMFAULT_CRC32_INITIAL_VALUE,
+    .crc_start_offset = sizeof(sMfltCoredumpHeader),
+  };
+
+  sMfltCoredumpFooter footer = { 0 };
+  if ((total_size < (sizeof(sMfltCoredumpHeader) + sizeof(footer))) ||
+      !prv_coredump_read_active(total_size - sizeof(footer), &footer, sizeof(footer)) ||
+      (footer.magic != MEMFAULT_COREDUMP_FOOTER_MAGIC)) {
+    state->result = kMemfaultCoredumpVerifyResult_Corrupt;
+    return;
+  }
+  if ((footer.flags & (1 << kMfltCoredumpBlockType_BlockCrc32)) == 0) {
+    // saved without CRC32 blocks so there is nothing to check
+    state->result = kMemfaultCoredumpVerifyResult_Valid;
+    return;
+  }
+  state->footer_offset = total_size - sizeof(footer);
+}
+
+//! Check the next block header or chunk of block payload
+//!
+//! @return the number of bytes checked, 0 if storage could not be read or the check completed
+static size_t prv_verify_next(sMfltCoredumpVerifyState *state, size_t max_bytes) {
+  if (state->offset < state->block_end) {
+    uint8_t buf[32];
+    const size_t read_size =
+      MEMFAULT_MIN(MEMFAULT_MIN(state->block_end - state->offset, max_bytes), sizeof(buf));
+    if (!prv_coredump_read_active(state->offset, buf, read_size)) {
+      return 0;
+    }
+    state->crc = memfault_crc32_compute(state->crc, buf, read_size);
+    state->offset += read_size;
+    return read_size;
+  }
+
+  if (state->offset == state->footer_offset) {
+    // everything up to the footer must be covered by a CRC32 block
+    state->result = (state->crc_start_offset == state->footer_offset) ?
+                      kMemfaultCoredumpVerifyResult_Valid :
+                      kMemfaultCoredumpVerifyResult_Corrupt;
+    return 0;
+  }
+
+  sMfltCoredumpBlock blk;
+  if ((state->footer_offset - state->offset) < sizeof(blk)) {
+    state->result = kMemfaultCoredumpVerifyResult_Corrupt;
+    return 0;
+  }
+  if (!prv_coredump_read_active(state->offset, &blk, sizeof(blk))) {
+    return 0;
+  }
+  if (blk.length > (state->footer_offset - state->offset - sizeof(blk))) {
+    state->result = kMemfaultCoredumpVerifyResult_Corrupt;
+    return 0;
+  }
+  state->block_end = state->offset + sizeof(blk) + blk.length;
+
+  if (blk.block_type != kMfltCoredumpRegionType_Crc32) {
+    state->crc = memfault_crc32_compute(state->crc, &blk, sizeof(blk));
+    state->offset += sizeof(blk);
+    return sizeof(blk);
+  }
+
+  // the unused fields of a CRC32 block header are not covered by any CRC so are checked here
+  uint32_t saved_crc;
+  if ((blk.length != sizeof(saved_crc)) || (blk.address != 0) ||
+      ((blk.rsvd[0] | blk.rsvd[1] | blk.rsvd[2]) != 0)) {
+    state->result = kMemfaultCoredumpVerifyResult_Corrupt;
+    return 0;
+  }
+  if (!prv_coredump_read_active(state->offset + sizeof(blk), &saved_crc, sizeof(saved_crc))) {
+    return 0;
+  }
+  if (saved_crc != state->crc) {
+    state->result = kMemfaultCoredumpVerifyResult_Corrupt;
+    return 0;
+  }
+  state->offset = state->block_end;
+  state->crc = MEMFAULT_CRC32_INITIAL_VALUE;
+  state->crc_start_offset = state->offset;
+  return MEMFAULT_COREDUMP_CRC_BLOCK_SIZE;
+}
+
+eMemfaultCoredumpVerifyResult memfault_coredump_verify_step(size_t max_bytes) {
+  sMfltCoredumpVerifyState *state = &s_mflt_coredump_verify;
+  size_t total_size = 0;
+  if (!memfault_coredump_has_valid_coredump(&total_size)) {
+    *state = (sMfltCoredumpVerifyState){ 0 };
+    return kMemfaultCoredumpVerifyResult_NoCoredump;
+  }
+
+#if MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS > 1
+  const uint32_t slot = s_mflt_coredump_slot_dir.read_slot;
+#else
+  const uint32_t slot = 0;
+#endif
+  if (!state->started || (state->slot != slot) || (state->total_size != total_size)) {
+    prv_verify_begin(state, slot, total_size);
+  }
+
+  while ((state->result == kMemfaultCoredumpVerifyResult_InProgress) && (max_bytes > 0)) {
+    const size_t bytes_checked = prv_verify_next(state, max_bytes);
+    if (bytes_checked == 0) {
+      break;
+    }
+    max_bytes -= MEMFAULT_MIN(bytes_checked, max_bytes);
+  }
+  return state->result;
+}
+
+//! Only report a coredump to the packetizer once its CRC32 blocks have been checked
+//!
+//! The check is spread over polls, MEMFAULT_COREDUMP_VERIFY_BYTES_PER_POLL bytes at a time, and
+//! its result is kept in s_mflt_coredump_verify so a verified coredump is not read again
+static bool prv_coredump_has_verified_coredump(size_t *total_size_out) {
+  // each pass discards a corrupt coredump, exposing the next slot
+  for (uint32_t i = 0; i < MEMFAULT_COREDUMP_STORAGE_NUM_SLOTS; i++) {
+    const eMemfaultCoredumpVerifyResult result =
+      memfault_coredump_verify_step(MEMFAULT_COREDUMP_VERIFY_BYTES_PER_POLL);
+    switch (result) {
+      case kMemfaultCoredumpVerifyResult_Valid:
+        if (total_size_out) {
+          *total_size_out = s_mflt_coredump_verify.total_size;
+        }
+        return true;
+      case kMemfaultCoredumpVerifyResult_Corrupt:
+        MEMFAULT_LOG_ERROR("Coredump failed CRC32 check, discarding");
+        prv_coredump_clear_active();
+        break;
+      case kMemfaultCoredumpVerifyResult_InProgress:
+      case kMemfaultCoredumpVerifyResult_NoCoredump:
+      default:
+        // the check continues on the next poll
+        return false;
+    }
+  }
+  return false;
+}
+
+#endif /* MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED */
+
 //! Expose a data source for use by the Memfault Packetizer
 const sMemfaultDataSourceImpl g_memfault_coredump_data_source = {
+#if MEMFAULT_COREDUMP_BLOCK_CRC_ENABLED
+  .has_more_msgs_cb = prv_coredump_has_verified_coredump,
+#else
   .has_more_msgs_cb = memfault_coredump_has_valid_coredump,
-  .read_msg_cb = memfault_coredump_read,
-  .mark_msg_read_cb = memfault_platform_coredump_storage_clear,
+#endif
+  .read_msg_cb = prv_coredump_read_active,
+  .mark_msg_read_cb = prv_coredump_clear_active,
+  .get_read_pointer_cb = prv_coredump_get_read_pointer_active,
 };
@@ -18,6 +18,15 @@
 //!   // analyze results from test and print results to console
 //!   memfault_coredump_storage_debug_test_finish();
 //! }
+//!
+//! void profile_coredump_storage_implementation(void) {
+//!   sMemfaultCoredumpStorageProfile profile;
+//!   // run with interrupts enabled so the time since boot advances
+//!   if (memfault_coredump_storage_debug_profile(&profile)) {
+//!     memfault_coredump_storage_debug_profile_print(&profile);
+//!   }
+//!   memfault_coredump_storage_debug_test_finish();
+//! }
 
 #include <stdbool.h>
 #include <stddef.h>
@@ -28,7 +37,9 @@
 #include "memfault-firmware-sdk/components/include/memfault/core/compiler.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/debug_log.h"
 #include "memfault-firmware-sdk/components/include/memfault/core/math.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/platform/core.h"
 #include "memfault-firmware-sdk/components/include/memfault/panics/coredump.h"
+#include "memfault-firmware-sdk/components/include/memfault/panics/coredump_impl.h"
 #include "memfault-firmware-sdk/components/include/memfault/panics/platform/coredump.h"
 
 typedef enum {
@@ -37,6 +48,7 @@ typedef enum {
   kMemfaultCoredumpStorageTestOp_Write,
   kMemfaultCoredumpStorageTestOp_Clear,
   kMemfaultCoredumpStorageTestOp_GetInfo,
+  kMemfaultCoredumpStorageTestOp_Read,
 } eMemfaultCoredumpStorageTestOp;
 
 typedef enum {
@@ -241,6 +253,197 @@ static bool prv_verify_coredump_clear_operation(void) {
   return true;
 }
 
+//
+// Storage throughput profiling
+//
+
+//! Large enough for every entry in MEMFAULT_COREDUMP_STORAGE_PROFILE_WRITE_SIZES
+static uint8_t s_profile_buf[256];
+
+static uint32_t prv_elapsed_ms(uint64_t start_ms) {
+  return (uint32_t)(memfault_platform_get_time_since_boot_ms() - start_ms);
+}
+
+static bool prv_profile_erase(size_t storage_size, uint32_t *elapsed_ms) {
+  const uint64_t start_ms = memfault_platform_get_time_since_boot_ms();
+  if (!memfault_platform_coredump_storage_erase(0, storage_size)) {
+    prv_record_failure(kMemfaultCoredumpStorageTestOp_Erase,
+                       kMemfaultCoredumpStorageResult_PlatformApiFail, 0, storage_size);
+    return false;
+  }
+  *elapsed_ms = prv_elapsed_ms(start_ms);
+  return true;
+}
+
+static bool prv_profile_write(size_t storage_size, size_t write_size, uint32_t *elapsed_ms) {
+  const uint64_t start_ms = memfault_platform_get_time_since_boot_ms();
+  for (size_t offset = 0; offset < storage_size; offset += write_size) {
+    const size_t len = MEMFAULT_MIN(write_size, storage_size - offset);
+    if (!memfault_platform_coredump_storage_write(offset, s_profile_buf, len)) {
+      prv_record_failure(kMemfaultCoredumpStorageTestOp_Write,
+                         kMemfaultCoredumpStorageResult_PlatformApiFail, offset, len);
+      return false;
+    }
+  }
+  *elapsed_ms = prv_elapsed_ms(start_ms);
+  return true;
+}
+
+static bool prv_profile_read(size_t storage_size, uint32_t *elapsed_ms) {
+  const uint64_t start_ms = memfault_platform_get_time_since_boot_ms();
+  for (size_t offset = 0; offset < storage_size; offset += sizeof(s_profile_buf)) {
+    const size_t len = MEMFAULT_MIN(sizeof(s_profile_buf), storage_size - offset);
+    // NB: memfault_coredump_read() since that is the routine used to drain coredumps
+    if (!memfault_coredump_read(offset, s_profile_buf, len)) {
+      prv_record_failure(kMemfaultCoredumpStorageTestOp_Read,
+                         kMemfaultCoredumpStorageResult_ReadFailed, offset, len);
+      return false;
+    }
+  }
+  *elapsed_ms = prv_elapsed_ms(start_ms);
+  return true;
+}
+
+//! Scale a time measured for the entire storage region to num_bytes, rounding up
+static uint32_t prv_scale_ms(uint32_t elapsed_ms, size_t num_bytes, size_t storage_size) {
+  return (uint32_t)(((uint64_t)elapsed_ms * num_bytes + storage_size - 1) / storage_size);
+}
+
+//! Estimate how long writing a coredump of save_size bytes to storage spends in storage routines,
+//! assuming storage was not pre-erased in the background. That is memfault_coredump_save(), or
+//! memfault_coredump_snapshot_commit() with MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE.
+static uint32_t prv_predict_storage_ms(const sMemfaultCoredumpStorageProfile *profile,
+                                       const sMfltCoredumpStorageInfo *info) {
+  const size_t slot_size = memfault_coredump_get_slot_size();
+  size_t write_bytes = MEMFAULT_MIN(profile->save_size, slot_size);
+#if MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0
+  // the coredump was truncated to the snapshot already
+  write_bytes = MEMFAULT_MIN(write_bytes, MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE);
+#endif
+
+#if MEMFAULT_COREDUMP_STORAGE_ERASE_LAZY
+  // only the sectors the coredump is written to are erased
+  const size_t sector_size = (info->sector_size != 0) ? info->sector_size : slot_size;
+  const size_t erase_bytes =
+    MEMFAULT_MIN(((write_bytes + sector_size - 1) / sector_size) * sector_size, slot_size);
+#else
+  (void)info;
+  const size_t erase_bytes = slot_size;
+#endif
+
+  // Without write combining, one write is issued per block so assume the smallest write size.
+  // Otherwise use the largest write size profiled which is not bigger than the combined writes.
+  size_t write_idx = 0;
+#if MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE != 0
+  for (size_t i = 1; i < MEMFAULT_COREDUMP_STORAGE_PROFILE_NUM_WRITE_SIZES; i++) {
+    if (profile->write_size[i] <= MEMFAULT_COREDUMP_STORAGE_WRITE_SIZE) {
+      write_idx = i;
+    }
+  }
+#endif
+
+  return prv_scale_ms(profile->erase_ms, erase_bytes, profile->storage_size) +
+         prv_scale_ms(profile->write_ms[write_idx], write_bytes, profile->storage_size);
+}
+
+bool memfault_coredump_storage_debug_profile(sMemfaultCoredumpStorageProfile *profile) {
+  static const uint32_t s_write_sizes[] = MEMFAULT_COREDUMP_STORAGE_PROFILE_WRITE_SIZES;
+  MEMFAULT_STATIC_ASSERT(MEMFAULT_ARRAY_SIZE(s_write_sizes) ==
+                           MEMFAULT_COREDUMP_STORAGE_PROFILE_NUM_WRITE_SIZES,
+                         "Write size list and count are out of sync");
+
+  *profile = (sMemfaultCoredumpStorageProfile){ 0 };
+
+  sMfltCoredumpStorageInfo info = { 0 };
+  memfault_platform_coredump_storage_get_info(&info);
+  if (info.size == 0) {
+    prv_record_failure(kMemfaultCoredumpStorageTestOp_GetInfo,
+                       kMemfaultCoredumpStorageResult_PlatformApiFail, 0, info.size);
+    return false;
+  }
+  profile->storage_size = info.size;
+  profile->save_size = memfault_coredump_storage_compute_size_required();
+
+  if (!memfault_platform_coredump_save_begin()) {
+    prv_record_failure(kMemfaultCoredumpStorageTestOp_Prepare,
+                       kMemfaultCoredumpStorageResult_PlatformApiFail, 0, info.size);
+    return false;
+  }
+
+  for (size_t i = 0; i < sizeof(s_profile_buf); i++) {
+    s_profile_buf[i] = (uint8_t)i;
+  }
+
+  // storage must be erased before each write pass; the first erase is the one reported
+  for (size_t i = 0; i < MEMFAULT_COREDUMP_STORAGE_PROFILE_NUM_WRITE_SIZES; i++) {
+    uint32_t erase_ms = 0;
+    if (!prv_profile_erase(info.size, &erase_ms)) {
+      return false;
+    }
+    if (i == 0) {
+      profile->erase_ms = erase_ms;
+    }
+
+    profile->write_size[i] = s_write_sizes[i];
+    if (!prv_profile_write(info.size, s_write_sizes[i], &profile->write_ms[i])) {
+      return false;
+    }
+  }
+
+  if (!prv_profile_read(info.size, &profile->read_ms)) {
+    return false;
+  }
+
+#if MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0
+  // the fault handler only copies the coredump to RAM, storage is written by the commit
+  profile->predicted_commit_ms = prv_predict_storage_ms(profile, &info);
+#else
+  profile->predicted_save_ms = prv_predict_storage_ms(profile, &info);
+#endif
+
+  s_test_result = (sMemfaultCoredumpStorageTestResult){
+    .result = kMemfaultCoredumpStorageResult_Success,
+  };
+  return true;
+}
+
+static void prv_log_throughput(const char *op, uint32_t size, uint32_t elapsed_ms,
+                               uint32_t storage_size) {
+  if (elapsed_ms == 0) {
+    MEMFAULT_LOG_INFO("%-10s|%6" PRIu32 "|%8s|%10s|", op, size, "<1", "-");
+    return;
+  }
+  const uint32_t kib_per_sec = (uint32_t)(((uint64_t)storage_size * 1000) / elapsed_ms / 1024);
+  MEMFAULT_LOG_INFO("%-10s|%6" PRIu32 "|%8" PRIu32 "|%10" PRIu32 "|", op, size, elapsed_ms,
+                    kib_per_sec);
+}
+
+void memfault_coredump_storage_debug_profile_print(const sMemfaultCoredumpStorageProfile *profile) {
+  MEMFAULT_LOG_INFO("Coredump storage profile, %" PRIu32 " bytes", profile->storage_size);
+  MEMFAULT_LOG_INFO("-------------------------------------");
+  MEMFAULT_LOG_INFO("%-10s|%6s|%8s|%10s|", "Op", "Size", "Time ms", "KiB/s");
+  MEMFAULT_LOG_INFO("-------------------------------------");
+  prv_log_throughput("erase", profile->storage_size, profile->erase_ms, profile->storage_size);
+  for (size_t i = 0; i < MEMFAULT_COREDUMP_STORAGE_PROFILE_NUM_WRITE_SIZES; i++) {
+    prv_log_throughput("write", profile->write_size[i], profile->write_ms[i],
+                       profile->storage_size);
+  }
+  prv_log_throughput("read", (uint32_t)sizeof(s_profile_buf), profile->read_ms,
+                     profile->storage_size);
+  MEMFAULT_LOG_INFO("-------------------------------------");
+#if MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE > 0
+  MEMFAULT_LOG_INFO("Coredump saved to a %d byte RAM snapshot, no storage work from the fault",
+                    MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE);
+  const uint32_t commit_size =
+    MEMFAULT_MIN(profile->save_size, (uint32_t)MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE);
+  MEMFAULT_LOG_INFO("Predicted snapshot commit: %" PRIu32 " ms for %" PRIu32 " bytes",
+                    profile->predicted_commit_ms, commit_size);
+#else
+  MEMFAULT_LOG_INFO("Predicted coredump save: %" PRIu32 " ms for %" PRIu32 " bytes",
+                    profile->predicted_save_ms, profile->save_size);
+#endif
+}
+
 static void prv_log_error_hexdump(const char *prefix, const uint8_t *buf, size_t buf_len) {
 #define MAX_BUF_LEN (sizeof(s_read_buf) * 2 + 1)
   char hex_buffer[MAX_BUF_LEN];
@@ -283,6 +486,10 @@ bool memfault_coredump_storage_debug_test_finish(void) {
       op_suffix = "get info";
       break;
 
+    case kMemfaultCoredumpStorageTestOp_Read:
+      op_suffix = "read";
+      break;
+
     default:
       op_suffix = "unknown";
       break;
@@ -8,23 +8,20 @@
 
 #include "memfault-firmware-sdk/components/include/memfault/core/debug_log.h"
 #include "memfault-firmware-sdk/components/include/memfault/panics/coredump.h"
+#include "memfault-firmware-sdk/components/include/memfault/panics/coredump_impl.h"
 
 bool memfault_coredump_storage_check_size(void) {
-  sMfltCoredumpStorageInfo storage_info = { 0 };
-  memfault_platform_coredump_storage_get_info(&storage_info);
+  const size_t storage_size = memfault_coredump_get_slot_size();
   const size_t size_needed = memfault_coredump_storage_compute_size_required();
-  if (size_needed <= storage_info.size) {
+  if (size_needed <= storage_size) {
     return true;
   }
 
-  MEMFAULT_LOG_WARN("Coredump storage is %dB but need %dB", (int)storage_info.size,
-                    (int)size_needed);
+  MEMFAULT_LOG_WARN("Coredump storage is %dB but need %dB", (int)storage_size, (int)size_needed);
   return false;
 }
 
 void memfault_coredump_size_and_storage_capacity(size_t *total_size, size_t *capacity) {
-  sMfltCoredumpStorageInfo storage_info = { 0 };
-  memfault_platform_coredump_storage_get_info(&storage_info);
-  *capacity = storage_info.size;
+  *capacity = memfault_coredump_get_slot_size();
   *total_size = memfault_coredump_storage_compute_size_required();
 }
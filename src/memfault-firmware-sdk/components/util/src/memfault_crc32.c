@@ -0,0 +1,34 @@
+//! @file
+//!
+//! Copyright (c) Memfault, Inc.
+//! See License.txt for details
+
+#include <inttypes.h>
+#include <stddef.h>
+
+#include "memfault-firmware-sdk/components/include/memfault/core/compiler.h"
+#include "memfault-firmware-sdk/components/include/memfault/core/math.h"
+#include "memfault-firmware-sdk/components/include/memfault/util/crc32.h"
+
+// A table indexed by nibble rather than byte is 16x smaller and still only needs two lookups
+// per byte
+static const uint32_t s_crc32_nibble_table[] = {
+  0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+  0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+};
+MEMFAULT_STATIC_ASSERT(MEMFAULT_ARRAY_SIZE(s_crc32_nibble_table) == 16,
+                       "Unexpected CRC lookup table size");
+
+uint32_t memfault_crc32_compute(uint32_t crc_initial_value, const void *data,
+                                size_t data_len_bytes) {
+  uint32_t crc = ~crc_initial_value;
+
+  const uint8_t *curr_ptr = data;
+  for (size_t i = 0; i < data_len_bytes; i++) {
+    crc ^= *curr_ptr++;
+    crc = (crc >> 4) ^ s_crc32_nibble_table[crc & 0xf];
+    crc = (crc >> 4) ^ s_crc32_nibble_table[crc & 0xf];
+  }
+
+  return ~crc;
+}
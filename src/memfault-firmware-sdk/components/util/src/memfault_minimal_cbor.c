@@ -121,6 +121,21 @@ static void prv_encode_uint64(uint8_t buf[8], uint64_t val) {
 
 #define MEMFAULT_CBOR_UINT64_MAX_ITEM_SIZE_BYTES 9
 
+//! Same as prv_encode_unsigned_integer() but for a 64 bit argument. Values which fit in 32 bits
+//! use the shorter encodings.
+static bool prv_encode_unsigned_long_integer(sMemfaultCborEncoder *encoder, uint8_t major_type,
+                                             uint64_t val) {
+  if (val <= UINT32_MAX) {
+    return prv_encode_unsigned_integer(encoder, major_type, (uint32_t)val);
+  }
+
+  uint8_t tmp_buf[MEMFAULT_CBOR_UINT64_MAX_ITEM_SIZE_BYTES];
+  const uint8_t uint64_type_value = 27;
+  tmp_buf[0] = CBOR_SERIALIZE_MAJOR_TYPE(major_type) | uint64_type_value;
+  prv_encode_uint64(&tmp_buf[1], val);
+  return prv_add_to_result_buffer(encoder, tmp_buf, sizeof(tmp_buf));
+}
+
 bool memfault_cbor_encode_long_signed_integer(sMemfaultCborEncoder *encoder, int64_t value) {
   // Logic derived from "Appendix C Pseudocode" of RFC 7049. Suppress
   // CodeChecker violation, this has predictable output on supported compilers
@@ -130,15 +145,11 @@ bool memfault_cbor_encode_long_signed_integer(sMemfaultCborEncoder *encoder, int
   const uint8_t cbor_major_type = ui & 0x1;
   ui ^= value;
 
-  if (ui <= UINT32_MAX) {
-    return prv_encode_unsigned_integer(encoder, cbor_major_type, (uint32_t)ui);
-  }
+  return prv_encode_unsigned_long_integer(encoder, cbor_major_type, (uint64_t)ui);
+}
 
-  uint8_t tmp_buf[MEMFAULT_CBOR_UINT64_MAX_ITEM_SIZE_BYTES];
-  const uint8_t uint64_type_value = 27;
-  tmp_buf[0] = CBOR_SERIALIZE_MAJOR_TYPE(cbor_major_type) | uint64_type_value;
-  prv_encode_uint64(&tmp_buf[1], (uint64_t)ui);
-  return prv_add_to_result_buffer(encoder, tmp_buf, sizeof(tmp_buf));
+bool memfault_cbor_encode_long_unsigned_integer(sMemfaultCborEncoder *encoder, uint64_t value) {
+  return prv_encode_unsigned_long_integer(encoder, kCborMajorType_UnsignedInteger, value);
 }
 
 bool memfault_cbor_encode_uint64_as_double(sMemfaultCborEncoder *encoder, uint64_t val) {
@@ -17,6 +17,22 @@ size_t memfault_encode_varint_u32(uint32_t value, void *buf) {
   return (size_t)(res - (uint8_t *)buf);
 }
 
+size_t memfault_decode_varint_u32(const void *buf, size_t buf_len, uint32_t *value) {
+  const uint8_t *bytes = buf;
+  uint32_t result = 0;
+
+  for (size_t i = 0; (i < buf_len) && (i < MEMFAULT_UINT32_MAX_VARINT_LENGTH); i++) {
+    result |= (uint32_t)(bytes[i] & 0x7f) << (7 * i);
+    if ((bytes[i] & 0x80) == 0) {
+      *value = result;
+      return i + 1;
+    }
+  }
+
+  // ran out of bytes before finding the terminating byte
+  return 0;
+}
+
 size_t memfault_encode_varint_si32(int32_t value, void *buf) {
   // A representation that maps negative numbers onto odd positive numbers and
   // positive numbers onto positive even numbers. Some example conversions follow:
@@ -13,6 +13,9 @@
 //! By default, it will collect the top of the stack which was running at the time of the
 //! crash. This allows for a reasonable backtrace to be collected while using very little RAM.
 //!
+//! To keep the fast save to RAM from the fault handler but persist coredumps to flash (i.e across
+//! a power loss), use a flash storage port with MEMFAULT_COREDUMP_RAM_SNAPSHOT_SIZE instead.
+//!
 //! Place the "noinit" region in an area of RAM that will persist across bootup.
 //!    The region must:
 //!    - not be placed in .bss
@@ -97,6 +100,20 @@ bool memfault_platform_coredump_storage_read(uint32_t offset, void *data, size_t
   return true;
 }
 
+bool memfault_platform_coredump_storage_get_read_pointer(uint32_t offset, const void **read_ptr,
+                                                         size_t *read_ptr_len) {
+  sMfltCoredumpStorageInfo info = { 0 };
+  memfault_platform_coredump_storage_get_info(&info);
+  if (offset >= info.size) {
+    return false;
+  }
+
+  const uint8_t *storage_ptr = MEMFAULT_PLATFORM_COREDUMP_RAM_START_ADDR;
+  *read_ptr = &storage_ptr[offset];
+  *read_ptr_len = info.size - offset;
+  return true;
+}
+
 bool memfault_platform_coredump_storage_erase(uint32_t offset, size_t erase_size) {
   if (!prv_op_within_flash_bounds(offset, erase_size)) {
     return false;